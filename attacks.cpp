@@ -1,169 +1,497 @@
+#include <cstdlib>
+#include <mutex>
 #include "attacks.h"
+#include "movegen.h"
 
-// Attack tables
-U64 pawn_attacks[2][64];
-U64 knight_attacks[64];
-U64 king_attacks[64];
+// Slider backend is chosen at compile time (see SLIDER_BACKEND in CMakeLists.txt):
+//   default                     magic bitboards (~850 KB of tables)
+//   SLIDER_BACKEND_HYPERBOLA    hyperbola quintessence (rays + 512 B rank table)
+//   SLIDER_BACKEND_OBSTRUCTION  obstruction difference (rays only)
+#if !defined(SLIDER_BACKEND_HYPERBOLA) && !defined(SLIDER_BACKEND_OBSTRUCTION)
+#define SLIDER_BACKEND_MAGIC
+#endif
 
-// Masks for file wrapping (0=a8 ... 63=h1)
-const U64 not_a_file = 0xfefefefefefefefe;
-const U64 not_h_file = 0x7f7f7f7f7f7f7f7f;
-const U64 not_hg_file = 0x3f3f3f3f3f3f3f3f;
-const U64 not_ab_file = 0xfcfcfcfcfcfcfcfc;
+// BMI2 PEXT backend is only compiled on x86-64; selected at runtime by CPUID
+#if defined(SLIDER_BACKEND_MAGIC) && defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define PEXT_BACKEND_AVAILABLE
+#endif
 
 // Mask pawn attacks
-U64 mask_pawn_attacks(int side, int square) {
-    U64 attacks = 0ULL;
-    U64 bitboard = 0ULL;
-    
-    set_bit(bitboard, square);
-    
-    // White pawns (Move UP, indices decrease)
-    if (!side) {
-        // Capture Right (-7: Up 1, Right 1) -> Avoid A file wrap
-        if ((bitboard >> 7) & not_a_file) attacks |= (bitboard >> 7);
-        // Capture Left (-9: Up 1, Left 1) -> Avoid H file wrap
-        if ((bitboard >> 9) & not_h_file) attacks |= (bitboard >> 9);
-    }
-    // Black pawns (Move DOWN, indices increase)
-    else {
-        // Capture Left (+7: Down 1, Left 1) -> Avoid H file wrap
-        if ((bitboard << 7) & not_h_file) attacks |= (bitboard << 7);
-        // Capture Right (+9: Down 1, Right 1) -> Avoid A file wrap
-        if ((bitboard << 9) & not_a_file) attacks |= (bitboard << 9);
+constexpr U64 mask_pawn_attacks(int side, int square) {
+    return pawn_attacks_set(side, 1ULL << square);
+}
+
+// Mask knight attacks
+constexpr U64 mask_knight_attacks(int square) {
+    return knight_attacks_set(1ULL << square);
+}
+
+// Mask king attacks
+constexpr U64 mask_king_attacks(int square) {
+    return king_attacks_set(1ULL << square);
+}
+
+constexpr std::array<std::array<U64, 64>, 2> init_pawn_attacks() {
+    std::array<std::array<U64, 64>, 2> attacks{};
+    for (int square = 0; square < 64; square++) {
+        attacks[0][square] = mask_pawn_attacks(0, square);
+        attacks[1][square] = mask_pawn_attacks(1, square);
     }
-    
     return attacks;
 }
 
-// Mask knight attacks
-U64 mask_knight_attacks(int square) {
-    U64 attacks = 0ULL;
-    U64 bitboard = 0ULL;
-    
-    set_bit(bitboard, square);
-    
-    // >> 17: Up 2 Left 1 (-17). Avoid H wrap.
-    if ((bitboard >> 17) & not_h_file) attacks |= (bitboard >> 17);
-    // >> 15: Up 2 Right 1 (-15). Avoid A wrap.
-    if ((bitboard >> 15) & not_a_file) attacks |= (bitboard >> 15);
-    // >> 10: Up 1 Left 2 (-10). Avoid GH wrap.
-    if ((bitboard >> 10) & not_hg_file) attacks |= (bitboard >> 10);
-    // >> 6: Up 1 Right 2 (-6). Avoid AB wrap.
-    if ((bitboard >> 6) & not_ab_file) attacks |= (bitboard >> 6);
-    
-    // << 17: Down 2 Right 1 (+17). Avoid A wrap.
-    if ((bitboard << 17) & not_a_file) attacks |= (bitboard << 17);
-    // << 15: Down 2 Left 1 (+15). Avoid H wrap.
-    if ((bitboard << 15) & not_h_file) attacks |= (bitboard << 15);
-    // << 10: Down 1 Right 2 (+10). Avoid AB wrap.
-    if ((bitboard << 10) & not_ab_file) attacks |= (bitboard << 10);
-    // << 6: Down 1 Left 2 (+6). Avoid GH wrap.
-    if ((bitboard << 6) & not_hg_file) attacks |= (bitboard << 6);
-    
+constexpr std::array<U64, 64> init_knight_attacks() {
+    std::array<U64, 64> attacks{};
+    for (int square = 0; square < 64; square++) attacks[square] = mask_knight_attacks(square);
     return attacks;
 }
 
-// Mask king attacks
-U64 mask_king_attacks(int square) {
+constexpr std::array<U64, 64> init_king_attacks() {
+    std::array<U64, 64> attacks{};
+    for (int square = 0; square < 64; square++) attacks[square] = mask_king_attacks(square);
+    return attacks;
+}
+
+// Leaper attack tables
+constexpr std::array<std::array<U64, 64>, 2> pawn_attacks = init_pawn_attacks();
+constexpr std::array<U64, 64> knight_attacks = init_knight_attacks();
+constexpr std::array<U64, 64> king_attacks = init_king_attacks();
+
+// Rank / file step per ray direction (rank 0 = 8th rank)
+constexpr int ray_steps[8][2] = {
+    {-1, 0}, {1, 0},  // North, South
+    {0, 1}, {0, -1},  // East, West
+    {-1, 1}, {1, -1}, // North East, South West
+    {-1, -1}, {1, 1}  // North West, South East
+};
+
+// Mask ray from square to the board edge
+constexpr U64 mask_ray(int direction, int square) {
     U64 attacks = 0ULL;
-    U64 bitboard = 0ULL;
-    
-    set_bit(bitboard, square);
+    int r = square / 8 + ray_steps[direction][0];
+    int f = square % 8 + ray_steps[direction][1];
     
-    // North/South
-    if (bitboard >> 8) attacks |= (bitboard >> 8);
-    if (bitboard << 8) attacks |= (bitboard << 8);
-    
-    // East/West (Right/Left)
-    if ((bitboard >> 1) & not_h_file) attacks |= (bitboard >> 1); // Left
-    if ((bitboard << 1) & not_a_file) attacks |= (bitboard << 1); // Right
-    
-    // Diagonals
-    if ((bitboard >> 9) & not_h_file) attacks |= (bitboard >> 9); // UL
-    if ((bitboard >> 7) & not_a_file) attacks |= (bitboard >> 7); // UR
-    if ((bitboard << 9) & not_a_file) attacks |= (bitboard << 9); // DR
-    if ((bitboard << 7) & not_h_file) attacks |= (bitboard << 7); // DL
+    for (; r >= 0 && r < 8 && f >= 0 && f < 8; r += ray_steps[direction][0], f += ray_steps[direction][1]) {
+        attacks |= (1ULL << (r * 8 + f));
+    }
     
     return attacks;
 }
 
-void init_leapers_attacks() {
-    for (int square = 0; square < 64; square++) {
-        pawn_attacks[0][square] = mask_pawn_attacks(0, square);
-        pawn_attacks[1][square] = mask_pawn_attacks(1, square);
-        
-        knight_attacks[square] = mask_knight_attacks(square);
-        king_attacks[square] = mask_king_attacks(square);
+constexpr std::array<std::array<U64, 64>, 8> init_rays() {
+    std::array<std::array<U64, 64>, 8> attacks{};
+    for (int direction = 0; direction < 8; direction++) {
+        for (int square = 0; square < 64; square++) attacks[direction][square] = mask_ray(direction, square);
     }
+    return attacks;
 }
 
-// Get bishop attacks
-U64 get_bishop_attacks(int square, U64 occupancy) {
+constexpr std::array<std::array<U64, 64>, 8> rays = init_rays();
+
+constexpr std::array<std::array<U64, 64>, 64> init_between() {
+    std::array<std::array<U64, 64>, 64> squares{};
+    for (int from = 0; from < 64; from++) {
+        for (int direction = 0; direction < 8; direction++) {
+            U64 ray = rays[direction][from];
+            for (int to = 0; to < 64; to++) {
+                // Ray up to the target, minus the part beyond and the target itself
+                if (get_bit(ray, to)) squares[from][to] = ray & ~rays[direction][to] & ~(1ULL << to);
+            }
+        }
+    }
+    return squares;
+}
+
+constexpr std::array<std::array<U64, 64>, 64> init_line() {
+    std::array<std::array<U64, 64>, 64> squares{};
+    for (int from = 0; from < 64; from++) {
+        for (int direction = 0; direction < 8; direction++) {
+            U64 full = rays[direction][from] | rays[direction ^ 1][from] | (1ULL << from);
+            for (int to = 0; to < 64; to++) {
+                if (get_bit(rays[direction][from], to)) squares[from][to] = full;
+            }
+        }
+    }
+    return squares;
+}
+
+constexpr std::array<std::array<U64, 64>, 64> between = init_between();
+constexpr std::array<std::array<U64, 64>, 64> line = init_line();
+
+#ifdef SLIDER_BACKEND_MAGIC
+
+// Mask bishop relevant occupancy (board edges excluded)
+constexpr U64 mask_bishop_attacks(int square) {
     U64 attacks = 0ULL;
-    int r, f;
+    int r = 0, f = 0;
     int tr = square / 8;
     int tf = square % 8;
     
-    // South East
-    for (r = tr + 1, f = tf + 1; r < 8 && f < 8; r++, f++) {
-        attacks |= (1ULL << (r * 8 + f));
-        if ((1ULL << (r * 8 + f)) & occupancy) break;
-    }
-    // North East
-    for (r = tr - 1, f = tf + 1; r >= 0 && f < 8; r--, f++) {
-        attacks |= (1ULL << (r * 8 + f));
-        if ((1ULL << (r * 8 + f)) & occupancy) break;
-    }
-    // South West
-    for (r = tr + 1, f = tf - 1; r < 8 && f >= 0; r++, f--) {
-        attacks |= (1ULL << (r * 8 + f));
-        if ((1ULL << (r * 8 + f)) & occupancy) break;
-    }
-    // North West
-    for (r = tr - 1, f = tf - 1; r >= 0 && f >= 0; r--, f--) {
-        attacks |= (1ULL << (r * 8 + f));
-        if ((1ULL << (r * 8 + f)) & occupancy) break;
-    }
+    for (r = tr + 1, f = tf + 1; r < 7 && f < 7; r++, f++) attacks |= (1ULL << (r * 8 + f));
+    for (r = tr - 1, f = tf + 1; r > 0 && f < 7; r--, f++) attacks |= (1ULL << (r * 8 + f));
+    for (r = tr + 1, f = tf - 1; r < 7 && f > 0; r++, f--) attacks |= (1ULL << (r * 8 + f));
+    for (r = tr - 1, f = tf - 1; r > 0 && f > 0; r--, f--) attacks |= (1ULL << (r * 8 + f));
     
     return attacks;
 }
 
-// Get rook attacks
-U64 get_rook_attacks(int square, U64 occupancy) {
+// Mask rook relevant occupancy (board edges excluded)
+constexpr U64 mask_rook_attacks(int square) {
     U64 attacks = 0ULL;
-    int r, f;
+    int r = 0, f = 0;
     int tr = square / 8;
     int tf = square % 8;
     
-    // South
-    for (r = tr + 1; r < 8; r++) {
-        attacks |= (1ULL << (r * 8 + tf));
-        if ((1ULL << (r * 8 + tf)) & occupancy) break;
-    }
-    // North
-    for (r = tr - 1; r >= 0; r--) {
-        attacks |= (1ULL << (r * 8 + tf));
-        if ((1ULL << (r * 8 + tf)) & occupancy) break;
-    }
-    // East
-    for (f = tf + 1; f < 8; f++) {
-        attacks |= (1ULL << (tr * 8 + f));
-        if ((1ULL << (tr * 8 + f)) & occupancy) break;
-    }
-    // West
-    for (f = tf - 1; f >= 0; f--) {
-        attacks |= (1ULL << (tr * 8 + f));
-        if ((1ULL << (tr * 8 + f)) & occupancy) break;
+    for (r = tr + 1; r < 7; r++) attacks |= (1ULL << (r * 8 + tf));
+    for (r = tr - 1; r > 0; r--) attacks |= (1ULL << (r * 8 + tf));
+    for (f = tf + 1; f < 7; f++) attacks |= (1ULL << (tr * 8 + f));
+    for (f = tf - 1; f > 0; f--) attacks |= (1ULL << (tr * 8 + f));
+    
+    return attacks;
+}
+
+// Magic numbers for the a8 = 0 square order.
+// Found by random search; each maps every subset of the relevant mask to a
+// distinct (or constructively colliding) index in 64 - popcount(mask) bits.
+constexpr U64 rook_magic_numbers[64] = {
+    0x00800080221a4000ULL, 0x2040002000401000ULL, 0xa900090010422000ULL, 0x0200041140200a00ULL,
+    0x1001008040200810ULL, 0x0200100200080401ULL, 0x0280108002000100ULL, 0x0200041500802242ULL,
+    0x200a002080420100ULL, 0x400c808040002000ULL, 0x0216801001200080ULL, 0x8201001000082100ULL,
+    0x2c40800800800400ULL, 0x0060808002000400ULL, 0x9021800100800200ULL, 0x6601000040810002ULL,
+    0x2080004020004001ULL, 0x1010024000402009ULL, 0x2000808020001000ULL, 0x0026020040201208ULL,
+    0x5004008004080081ULL, 0x0100808004000200ULL, 0x0000040002100801ULL, 0x4800020010440389ULL,
+    0x6200400080008020ULL, 0x00a0008280400220ULL, 0x0040120200208040ULL, 0x1288002101001000ULL,
+    0x0800080080040080ULL, 0x32802008010410c0ULL, 0x4202020400100801ULL, 0x80c00042000c00a1ULL,
+    0x4080004081002100ULL, 0x2800804000802001ULL, 0x0040100080802000ULL, 0x0201000821001002ULL,
+    0x0008001009000500ULL, 0x400a001492006810ULL, 0x0012508804000142ULL, 0x8021000045000882ULL,
+    0x2000204000908002ULL, 0x0240100028006000ULL, 0x2880110020010040ULL, 0x0001021002210008ULL,
+    0x0008020004004040ULL, 0x0009000804010002ULL, 0x0014020001008080ULL, 0x9004304401820005ULL,
+    0x0000220100408200ULL, 0x0050401008200040ULL, 0x0201801000200480ULL, 0x6485022008100100ULL,
+    0x1008440008008280ULL, 0x0009000400080300ULL, 0x0020080110020400ULL, 0x8440802100004080ULL,
+    0x0000210046128001ULL, 0x10010240002a1081ULL, 0x0c81114008200501ULL, 0x004100281000a015ULL,
+    0x0032002008041002ULL, 0x3206000130082422ULL, 0x000c101801122084ULL, 0x0008084030840102ULL
+};
+
+constexpr U64 bishop_magic_numbers[64] = {
+    0x0820200080810049ULL, 0x0222040804a90040ULL, 0x1010042048400060ULL, 0x0044040088828020ULL,
+    0xa008484140300880ULL, 0x0002226020020080ULL, 0x0021011003a00484ULL, 0x0100442084202001ULL,
+    0x8046425848009880ULL, 0x0143021001120098ULL, 0x0000220204082000ULL, 0x2a80944400808880ULL,
+    0x0002811040400308ULL, 0x0040011048040108ULL, 0x0300410802110438ULL, 0x0200820504024200ULL,
+    0x0840881022080120ULL, 0x00020c7104080481ULL, 0x004400020802010cULL, 0x8018009028401000ULL,
+    0x0486000400a2000cULL, 0x2000200d00884002ULL, 0x0004000212020280ULL, 0x8000808030880801ULL,
+    0x5810880850200161ULL, 0x0030c80350210108ULL, 0x0206a40088254400ULL, 0xb284004004010102ULL,
+    0x1006840008802000ULL, 0x1c30010008825102ULL, 0x0084840001015800ULL, 0x0200410004440200ULL,
+    0x0210101308240c21ULL, 0x0040823000206402ULL, 0x2084040400020020ULL, 0x6801040401080120ULL,
+    0x1240010100111040ULL, 0x4800880040020111ULL, 0x0808020440048800ULL, 0x0001404200048200ULL,
+    0x2804100410040400ULL, 0x0001308820000400ULL, 0x90041042280d1002ULL, 0x1020820214010200ULL,
+    0x5600204410100102ULL, 0x0040008a04100080ULL, 0x8021010208840208ULL, 0x8230011040800101ULL,
+    0x40248c3008050200ULL, 0x2001010090042821ULL, 0x000080210808080cULL, 0x201820b041108000ULL,
+    0x204c141082020004ULL, 0x0880850810244000ULL, 0x004084c408861340ULL, 0x0811010104008000ULL,
+    0x2081120811041000ULL, 0x808c020200840504ULL, 0x0085210021080805ULL, 0x0090000200840402ULL,
+    0x0000800040104128ULL, 0x0000a08450220201ULL, 0x000041680804a292ULL, 0x0002022812108200ULL
+};
+
+// Magic lookup entry: attacks = table[((occupancy & mask) * magic) >> shift]
+// With the PEXT backend the same entry is indexed by pext(occupancy, mask)
+struct Magic {
+    U64 mask;
+    U64 magic;
+    U64* attacks;
+    int shift;
+};
+
+Magic bishop_magics[64];
+Magic rook_magics[64];
+
+// Shared attack tables, each square owns a 2^popcount(mask) slice
+U64 bishop_table[5248];
+U64 rook_table[102400];
+
+// Active slider backend, chosen when the slider tables are built
+int slider_backend = SLIDER_MAGIC;
+
+#ifdef PEXT_BACKEND_AVAILABLE
+__attribute__((target("bmi2")))
+static U64 pext_index(U64 occupancy, U64 mask) {
+    return _pext_u64(occupancy, mask);
+}
+
+__attribute__((target("bmi2")))
+static U64 get_bishop_attacks_pext(int square, U64 occupancy) {
+    const Magic& m = bishop_magics[square];
+    return m.attacks[_pext_u64(occupancy, m.mask)];
+}
+
+__attribute__((target("bmi2")))
+static U64 get_rook_attacks_pext(int square, U64 occupancy) {
+    const Magic& m = rook_magics[square];
+    return m.attacks[_pext_u64(occupancy, m.mask)];
+}
+
+__attribute__((target("bmi2")))
+static U64 get_queen_attacks_pext(int square, U64 occupancy) {
+    const Magic& bm = bishop_magics[square];
+    const Magic& rm = rook_magics[square];
+    return bm.attacks[_pext_u64(occupancy, bm.mask)] | rm.attacks[_pext_u64(occupancy, rm.mask)];
+}
+#endif
+
+// Table index for a (masked) occupancy under the active backend
+static U64 slider_index(const Magic& m, U64 occupancy) {
+#ifdef PEXT_BACKEND_AVAILABLE
+    if (slider_backend == SLIDER_PEXT) return pext_index(occupancy, m.mask);
+#endif
+    return (occupancy * m.magic) >> m.shift;
+}
+
+// Fill one piece type's magic entries and attack table
+static void init_magics(Magic magics[], U64 table[], const U64 magic_numbers[], int bishop) {
+    U64* attacks = table;
+    
+    for (int square = 0; square < 64; square++) {
+        Magic& m = magics[square];
+        m.mask = bishop ? mask_bishop_attacks(square) : mask_rook_attacks(square);
+        m.magic = magic_numbers[square];
+        m.shift = 64 - __builtin_popcountll(m.mask);
+        m.attacks = attacks;
+        
+        // Enumerate every subset of the mask (carry-rippler)
+        U64 occupancy = 0ULL;
+        do {
+            attacks[slider_index(m, occupancy)] = bishop ?
+                bishop_attacks_on_the_fly(square, occupancy) :
+                rook_attacks_on_the_fly(square, occupancy);
+            occupancy = (occupancy - m.mask) & m.mask;
+        } while (occupancy);
+        
+        attacks += 1ULL << (64 - m.shift);
     }
+}
+
+static int init_sliders_attacks() {
+    slider_backend = SLIDER_MAGIC;
+#ifdef PEXT_BACKEND_AVAILABLE
+    // SLIDER_NO_PEXT=1 in the environment keeps magic multiplication on BMI2
+    // hosts, so tests can cover both index paths
+    __builtin_cpu_init();
+    const char* no_pext = getenv("SLIDER_NO_PEXT");
+    if (__builtin_cpu_supports("bmi2") && !(no_pext && *no_pext && *no_pext != '0')) slider_backend = SLIDER_PEXT;
+#endif
     
+    init_magics(bishop_magics, bishop_table, bishop_magic_numbers, 1);
+    init_magics(rook_magics, rook_table, rook_magic_numbers, 0);
+    return 1;
+}
+
+// The slider tables are too large to generate at compile time (compiler
+// constexpr step limits). They are built exactly once, by whichever comes
+// first: this file's static initializer, parse_fen, or an explicit call.
+// The once_flag is constant-initialized, so calling this from another
+// file's static initializer is safe whatever the initialization order.
+static std::once_flag sliders_once;
+
+void init_slider_attacks() {
+    std::call_once(sliders_once, init_sliders_attacks);
+}
+
+static const int sliders_initialized = (init_slider_attacks(), 1);
+
+// Get bishop attacks
+U64 get_bishop_attacks(int square, U64 occupancy) {
+#ifdef PEXT_BACKEND_AVAILABLE
+    if (slider_backend == SLIDER_PEXT) return get_bishop_attacks_pext(square, occupancy);
+#endif
+    const Magic& m = bishop_magics[square];
+    return m.attacks[((occupancy & m.mask) * m.magic) >> m.shift];
+}
+
+// Get rook attacks
+U64 get_rook_attacks(int square, U64 occupancy) {
+#ifdef PEXT_BACKEND_AVAILABLE
+    if (slider_backend == SLIDER_PEXT) return get_rook_attacks_pext(square, occupancy);
+#endif
+    const Magic& m = rook_magics[square];
+    return m.attacks[((occupancy & m.mask) * m.magic) >> m.shift];
+}
+
+// Get queen attacks
+U64 get_queen_attacks(int square, U64 occupancy) {
+#ifdef PEXT_BACKEND_AVAILABLE
+    if (slider_backend == SLIDER_PEXT) return get_queen_attacks_pext(square, occupancy);
+#endif
+    const Magic& bm = bishop_magics[square];
+    const Magic& rm = rook_magics[square];
+    return bm.attacks[((occupancy & bm.mask) * bm.magic) >> bm.shift] |
+           rm.attacks[((occupancy & rm.mask) * rm.magic) >> rm.shift];
+}
+
+#endif
+
+#if defined(SLIDER_BACKEND_HYPERBOLA)
+
+// First rank attacks [file][inner six occupancy bits], as an 8-bit rank mask
+constexpr std::array<std::array<uint8_t, 64>, 8> init_rank_attacks() {
+    std::array<std::array<uint8_t, 64>, 8> attacks{};
+    for (int file = 0; file < 8; file++) {
+        for (int inner = 0; inner < 64; inner++) {
+            // Square a8..h8 (0..7) with the rank occupancy in the low byte
+            attacks[file][inner] = (uint8_t)rook_attacks_on_the_fly(file, (U64)inner << 1);
+        }
+    }
     return attacks;
 }
 
+constexpr std::array<std::array<uint8_t, 64>, 8> rank_attacks = init_rank_attacks();
+
+int slider_backend = SLIDER_HYPERBOLA;
+
+// Hyperbola quintessence along a line with at most one square per rank.
+// o - 2s finds blockers towards higher indices; the byte swap mirrors the
+// board so the same subtraction works towards lower indices.
+static inline U64 hyperbola_attacks(int square, U64 occupancy, U64 mask) {
+    U64 slider = 1ULL << square;
+    U64 forward = occupancy & mask;
+    U64 reverse = __builtin_bswap64(forward);
+    forward -= slider;
+    reverse -= __builtin_bswap64(slider);
+    forward ^= __builtin_bswap64(reverse);
+    return forward & mask;
+}
+
+static inline U64 rank_line_attacks(int square, U64 occupancy) {
+    int shift = square & 56;
+    return (U64)rank_attacks[square & 7][(occupancy >> (shift + 1)) & 63] << shift;
+}
+
+// Get bishop attacks
+U64 get_bishop_attacks(int square, U64 occupancy) {
+    return hyperbola_attacks(square, occupancy, rays[NORTH_WEST][square] | rays[SOUTH_EAST][square]) |
+           hyperbola_attacks(square, occupancy, rays[NORTH_EAST][square] | rays[SOUTH_WEST][square]);
+}
+
+// Get rook attacks
+U64 get_rook_attacks(int square, U64 occupancy) {
+    return hyperbola_attacks(square, occupancy, rays[NORTH][square] | rays[SOUTH][square]) |
+           rank_line_attacks(square, occupancy);
+}
+
+#elif defined(SLIDER_BACKEND_OBSTRUCTION)
+
+int slider_backend = SLIDER_OBSTRUCTION;
+
+// Obstruction difference along a line.
+// lower: ray towards lower indices, upper: ray towards higher indices.
+// The nearest lower blocker is the most significant bit of lower & occupancy,
+// the nearest upper blocker the least significant bit of upper & occupancy.
+static inline U64 obstruction_attacks(U64 occupancy, U64 lower, U64 upper) {
+    U64 lower_blockers = lower & occupancy;
+    U64 upper_blockers = upper & occupancy;
+    U64 lower_ms1b = ~0ULL << (63 - __builtin_clzll(lower_blockers | 1));
+    U64 upper_ls1b = upper_blockers & (0ULL - upper_blockers);
+    return (lower | upper) & (2 * upper_ls1b + lower_ms1b);
+}
+
+// Get bishop attacks
+U64 get_bishop_attacks(int square, U64 occupancy) {
+    return obstruction_attacks(occupancy, rays[NORTH_WEST][square], rays[SOUTH_EAST][square]) |
+           obstruction_attacks(occupancy, rays[NORTH_EAST][square], rays[SOUTH_WEST][square]);
+}
+
+// Get rook attacks
+U64 get_rook_attacks(int square, U64 occupancy) {
+    return obstruction_attacks(occupancy, rays[NORTH][square], rays[SOUTH][square]) |
+           obstruction_attacks(occupancy, rays[WEST][square], rays[EAST][square]);
+}
+
+#endif
+
+#ifndef SLIDER_BACKEND_MAGIC
+// Hyperbola and obstruction tables are generated at compile time
+void init_slider_attacks() {}
+
 // Get queen attacks
 U64 get_queen_attacks(int square, U64 occupancy) {
     return get_bishop_attacks(square, occupancy) | get_rook_attacks(square, occupancy);
 }
+#endif
+
+const char* slider_backend_name() {
+    switch (slider_backend) {
+        case SLIDER_PEXT: return "pext";
+        case SLIDER_HYPERBOLA: return "hyperbola";
+        case SLIDER_OBSTRUCTION: return "obstruction";
+    }
+    return "magic";
+}
+
+// Kogge-Stone occluded fill towards higher indices (South / East side).
+// Returns the attacks of every slider in gen along that direction.
+static U64 fill_attacks_up(U64 gen, U64 empty, int shift, U64 wrap) {
+    empty &= wrap;
+    gen |= empty & (gen << shift);
+    empty &= (empty << shift);
+    gen |= empty & (gen << (2 * shift));
+    empty &= (empty << (2 * shift));
+    gen |= empty & (gen << (4 * shift));
+    return (gen << shift) & wrap;
+}
+
+// Kogge-Stone occluded fill towards lower indices (North / West side)
+static U64 fill_attacks_down(U64 gen, U64 empty, int shift, U64 wrap) {
+    empty &= wrap;
+    gen |= empty & (gen >> shift);
+    empty &= (empty >> shift);
+    gen |= empty & (gen >> (2 * shift));
+    empty &= (empty >> (2 * shift));
+    gen |= empty & (gen >> (4 * shift));
+    return (gen >> shift) & wrap;
+}
+
+// Diagonal attacks of a whole set of bishops/queens
+U64 bishop_attacks_set(U64 bishops, U64 occupancy) {
+    U64 empty = ~occupancy;
+    return fill_attacks_up(bishops, empty, 9, not_a_file) |   // South East
+           fill_attacks_up(bishops, empty, 7, not_h_file) |   // South West
+           fill_attacks_down(bishops, empty, 7, not_a_file) | // North East
+           fill_attacks_down(bishops, empty, 9, not_h_file);  // North West
+}
+
+// Orthogonal attacks of a whole set of rooks/queens
+U64 rook_attacks_set(U64 rooks, U64 occupancy) {
+    U64 empty = ~occupancy;
+    return fill_attacks_up(rooks, empty, 8, ~0ULL) |          // South
+           fill_attacks_up(rooks, empty, 1, not_a_file) |     // East
+           fill_attacks_down(rooks, empty, 8, ~0ULL) |        // North
+           fill_attacks_down(rooks, empty, 1, not_h_file);    // West
+}
+
+// All squares attacked by a given side
+U64 attacked_squares(int side, const U64 bitboards[], U64 occupancy) {
+    U64 pawns = (!side) ? bitboards[P] : bitboards[p];
+    U64 knights = (!side) ? bitboards[N] : bitboards[n];
+    U64 kings = (!side) ? bitboards[K] : bitboards[k];
+    U64 bishop_queen = (!side) ? (bitboards[B] | bitboards[Q]) : (bitboards[b] | bitboards[q]);
+    U64 rook_queen = (!side) ? (bitboards[R] | bitboards[Q]) : (bitboards[r] | bitboards[q]);
+    
+    return pawn_attacks_set(side, pawns) |
+           knight_attacks_set(knights) |
+           king_attacks_set(kings) |
+           bishop_attacks_set(bishop_queen, occupancy) |
+           rook_attacks_set(rook_queen, occupancy);
+}
+
+// All pieces of both sides attacking a square.
+// Pass a modified occupancy to see x-rays (e.g. with a blocker removed).
+U64 attackers_to(int square, U64 occupancy, const U64 bitboards[]) {
+    // Pawn attacks are reversed: a black pawn on 'square' hits the white pawns that attack it
+    return (pawn_attacks[1][square] & bitboards[P]) |
+           (pawn_attacks[0][square] & bitboards[p]) |
+           (knight_attacks[square] & (bitboards[N] | bitboards[n])) |
+           (king_attacks[square] & (bitboards[K] | bitboards[k])) |
+           (get_bishop_attacks(square, occupancy) & (bitboards[B] | bitboards[b] | bitboards[Q] | bitboards[q])) |
+           (get_rook_attacks(square, occupancy) & (bitboards[R] | bitboards[r] | bitboards[Q] | bitboards[q]));
+}
 
 // Check if square is attacked
 int is_square_attacked(int square, int side, U64 bitboards[], U64 occupancies[]) {
@@ -199,3 +527,62 @@ int is_square_attacked(int square, int side, U64 bitboards[], U64 occupancies[])
     
     return 0;
 }
+
+// X-ray attacks: squares a rook/bishop on 'square' would additionally attack
+// if the first pieces of 'blockers' on its rays were removed
+U64 xray_rook_attacks(int square, U64 occupancy, U64 blockers) {
+    U64 attacks = get_rook_attacks(square, occupancy);
+    blockers &= attacks;
+    return attacks ^ get_rook_attacks(square, occupancy ^ blockers);
+}
+
+U64 xray_bishop_attacks(int square, U64 occupancy, U64 blockers) {
+    U64 attacks = get_bishop_attacks(square, occupancy);
+    blockers &= attacks;
+    return attacks ^ get_bishop_attacks(square, occupancy ^ blockers);
+}
+
+// Enemy pieces giving check to the side to move
+U64 checkers(const Board& board) {
+    U64 king = board.bitboards[board.side == 0 ? K : k];
+    if (!king) return 0ULL;
+    
+    int king_sq = __builtin_ctzll(king);
+    return attackers_to(king_sq, board.occupancies[2], board.bitboards) & board.occupancies[1 - board.side];
+}
+
+// Pieces of 'own' standing alone between the king of 'king_side' and a
+// slider of 'slider_side' that would attack it on an empty board
+static U64 blockers(const Board& board, int king_side, int slider_side, int own) {
+    U64 king = board.bitboards[king_side == 0 ? K : k];
+    if (!king) return 0ULL;
+    
+    int king_sq = __builtin_ctzll(king);
+    U64 rook_queen = (slider_side == 0) ? (board.bitboards[R] | board.bitboards[Q]) : (board.bitboards[r] | board.bitboards[q]);
+    U64 bishop_queen = (slider_side == 0) ? (board.bitboards[B] | board.bitboards[Q]) : (board.bitboards[b] | board.bitboards[q]);
+    
+    U64 snipers = (get_rook_attacks(king_sq, 0ULL) & rook_queen) |
+                  (get_bishop_attacks(king_sq, 0ULL) & bishop_queen);
+    U64 result = 0ULL;
+    
+    while (snipers) {
+        int sniper = __builtin_ctzll(snipers);
+        U64 between_pieces = between[king_sq][sniper] & board.occupancies[2];
+        
+        // Exactly one piece in between, and it belongs to 'own'
+        if (between_pieces && !(between_pieces & (between_pieces - 1))) result |= between_pieces & board.occupancies[own];
+        
+        pop_bit(snipers, sniper);
+    }
+    
+    return result;
+}
+
+// Pieces of 'side' that are absolutely pinned to their own king
+U64 pinned_pieces(const Board& board, int side) {
+    return blockers(board, side, side ^ 1, side);
+}
+
+U64 discovered_check_candidates(const Board& board, int side) {
+    return blockers(board, side ^ 1, side, side);
+}
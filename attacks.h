@@ -2,21 +2,191 @@
 #define ATTACKS_H
 
 #include "bitboard.h"
+#include <array>
+
+struct Board; // movegen.h
+
+// Masks for file wrapping (0=a8 ... 63=h1)
+constexpr U64 not_a_file = 0xfefefefefefefefe;
+constexpr U64 not_h_file = 0x7f7f7f7f7f7f7f7f;
+constexpr U64 not_hg_file = 0x3f3f3f3f3f3f3f3f;
+constexpr U64 not_ab_file = 0xfcfcfcfcfcfcfcfc;
+
+// Ray directions (opposite direction = dir ^ 1)
+enum {
+    NORTH, SOUTH,
+    EAST, WEST,
+    NORTH_EAST, SOUTH_WEST,
+    NORTH_WEST, SOUTH_EAST
+};
+
+// All tables below are generated at compile time (read-only data, no init call)
 
 // Leaper pieces attack tables [square]
-extern U64 pawn_attacks[2][64];
-extern U64 knight_attacks[64];
-extern U64 king_attacks[64];
+extern const std::array<std::array<U64, 64>, 2> pawn_attacks;
+extern const std::array<U64, 64> knight_attacks;
+extern const std::array<U64, 64> king_attacks;
+
+// Rays from a square to the board edge [direction][square] (square excluded)
+extern const std::array<std::array<U64, 64>, 8> rays;
+// Squares strictly between two aligned squares, 0 if not aligned [from][to]
+extern const std::array<std::array<U64, 64>, 64> between;
+// Full edge-to-edge line through two aligned squares, 0 if not aligned [from][to]
+extern const std::array<std::array<U64, 64>, 64> line;
+
+// Slider lookup backends
+enum { SLIDER_MAGIC, SLIDER_PEXT, SLIDER_HYPERBOLA, SLIDER_OBSTRUCTION };
+
+// Active backend: chosen at compile time, magic builds switch to PEXT at
+// startup when the CPU has BMI2 (unless SLIDER_NO_PEXT=1 is set in the
+// environment)
+extern int slider_backend;
+const char* slider_backend_name();
 
-// Function to initialize leaper attack tables
-void init_leapers_attacks();
+// Build the magic / PEXT slider tables (no-op for the other backends).
+// Runs once, before main() or on the first parse_fen, whichever is first.
+// Code that queries sliders from its own static initializers, before any
+// parse_fen, must call it first; it is thread-safe and cheap to repeat.
+void init_slider_attacks();
 
-// Slider attacks (on-the-fly)
+// Slider attacks (via the active backend)
 U64 get_bishop_attacks(int square, U64 occupancy);
 U64 get_rook_attacks(int square, U64 occupancy);
 U64 get_queen_attacks(int square, U64 occupancy);
 
+// Set-wise attacks (whole bitboard of pieces at once)
+
+// Pawn attacks of a whole set of pawns
+constexpr U64 pawn_attacks_set(int side, U64 pawns) {
+    // White pawns (Move UP, indices decrease)
+    if (!side) {
+        // Capture Right (-7: Up 1, Right 1) -> Avoid A file wrap
+        // Capture Left (-9: Up 1, Left 1) -> Avoid H file wrap
+        return ((pawns >> 7) & not_a_file) | ((pawns >> 9) & not_h_file);
+    }
+    // Black pawns (Move DOWN, indices increase)
+    // Capture Left (+7: Down 1, Left 1) -> Avoid H file wrap
+    // Capture Right (+9: Down 1, Right 1) -> Avoid A file wrap
+    return ((pawns << 7) & not_h_file) | ((pawns << 9) & not_a_file);
+}
+
+// Knight attacks of a whole set of knights
+constexpr U64 knight_attacks_set(U64 knights) {
+    U64 attacks = 0ULL;
+
+    // >> 17: Up 2 Left 1 (-17). Avoid H wrap.
+    attacks |= (knights >> 17) & not_h_file;
+    // >> 15: Up 2 Right 1 (-15). Avoid A wrap.
+    attacks |= (knights >> 15) & not_a_file;
+    // >> 10: Up 1 Left 2 (-10). Avoid GH wrap.
+    attacks |= (knights >> 10) & not_hg_file;
+    // >> 6: Up 1 Right 2 (-6). Avoid AB wrap.
+    attacks |= (knights >> 6) & not_ab_file;
+
+    // << 17: Down 2 Right 1 (+17). Avoid A wrap.
+    attacks |= (knights << 17) & not_a_file;
+    // << 15: Down 2 Left 1 (+15). Avoid H wrap.
+    attacks |= (knights << 15) & not_h_file;
+    // << 10: Down 1 Right 2 (+10). Avoid AB wrap.
+    attacks |= (knights << 10) & not_ab_file;
+    // << 6: Down 1 Left 2 (+6). Avoid GH wrap.
+    attacks |= (knights << 6) & not_hg_file;
+
+    return attacks;
+}
+
+// King attacks of a whole set of kings
+constexpr U64 king_attacks_set(U64 kings) {
+    // East/West (Right/Left) first, then spread the row North/South
+    U64 attacks = ((kings >> 1) & not_h_file) | ((kings << 1) & not_a_file);
+    U64 row = attacks | kings;
+    return attacks | (row >> 8) | (row << 8);
+}
+
+U64 bishop_attacks_set(U64 bishops, U64 occupancy); // Kogge-Stone fill
+U64 rook_attacks_set(U64 rooks, U64 occupancy);     // Kogge-Stone fill
+
+// All squares attacked by a given side (0=white, 1=black)
+U64 attacked_squares(int side, const U64 bitboards[], U64 occupancy);
+
+// Slider attacks on the fly (reference ray walk, used to build and verify the tables)
+constexpr U64 bishop_attacks_on_the_fly(int square, U64 occupancy) {
+    U64 attacks = 0ULL;
+    int r = 0, f = 0;
+    int tr = square / 8;
+    int tf = square % 8;
+
+    // South East
+    for (r = tr + 1, f = tf + 1; r < 8 && f < 8; r++, f++) {
+        attacks |= (1ULL << (r * 8 + f));
+        if ((1ULL << (r * 8 + f)) & occupancy) break;
+    }
+    // North East
+    for (r = tr - 1, f = tf + 1; r >= 0 && f < 8; r--, f++) {
+        attacks |= (1ULL << (r * 8 + f));
+        if ((1ULL << (r * 8 + f)) & occupancy) break;
+    }
+    // South West
+    for (r = tr + 1, f = tf - 1; r < 8 && f >= 0; r++, f--) {
+        attacks |= (1ULL << (r * 8 + f));
+        if ((1ULL << (r * 8 + f)) & occupancy) break;
+    }
+    // North West
+    for (r = tr - 1, f = tf - 1; r >= 0 && f >= 0; r--, f--) {
+        attacks |= (1ULL << (r * 8 + f));
+        if ((1ULL << (r * 8 + f)) & occupancy) break;
+    }
+
+    return attacks;
+}
+
+constexpr U64 rook_attacks_on_the_fly(int square, U64 occupancy) {
+    U64 attacks = 0ULL;
+    int r = 0, f = 0;
+    int tr = square / 8;
+    int tf = square % 8;
+
+    // South
+    for (r = tr + 1; r < 8; r++) {
+        attacks |= (1ULL << (r * 8 + tf));
+        if ((1ULL << (r * 8 + tf)) & occupancy) break;
+    }
+    // North
+    for (r = tr - 1; r >= 0; r--) {
+        attacks |= (1ULL << (r * 8 + tf));
+        if ((1ULL << (r * 8 + tf)) & occupancy) break;
+    }
+    // East
+    for (f = tf + 1; f < 8; f++) {
+        attacks |= (1ULL << (tr * 8 + f));
+        if ((1ULL << (tr * 8 + f)) & occupancy) break;
+    }
+    // West
+    for (f = tf - 1; f >= 0; f--) {
+        attacks |= (1ULL << (tr * 8 + f));
+        if ((1ULL << (tr * 8 + f)) & occupancy) break;
+    }
+
+    return attacks;
+}
+
 // Check if square is attacked by a given side
 int is_square_attacked(int square, int side, U64 bitboards[], U64 occupancies[]);
 
+// Attackers of both sides on a square (AND with occupancies[side] for one side)
+U64 attackers_to(int square, U64 occupancy, const U64 bitboards[]);
+
+// Enemy pieces giving check to the side to move
+U64 checkers(const Board& board);
+// Pieces of 'side' pinned to their own king by an enemy slider
+U64 pinned_pieces(const Board& board, int side);
+// Pieces of 'side' blocking one of its own sliders from the enemy king
+// (moving one off the line gives a discovered check)
+U64 discovered_check_candidates(const Board& board, int side);
+
+// X-ray attacks: extra squares a slider on 'square' reaches when the first
+// pieces of 'blockers' on its rays are removed
+U64 xray_rook_attacks(int square, U64 occupancy, U64 blockers);
+U64 xray_bishop_attacks(int square, U64 occupancy, U64 blockers);
+
 #endif
@@ -110,13 +110,11 @@ void render_board(const Board& board, const std::string& filename) {
             int square = rank * 8 + file;
             char piece_char = ' ';
             
-            // Check piece on this square
-            for (int p = P; p <= k; p++) {
-                if (get_bit(board.bitboards[p], square)) {
-                    const char piece_chars[] = "PNBRQKpnbrqk";
-                    piece_char = piece_chars[p];
-                    break;
-                }
+            // Piece on this square (mailbox lookup)
+            int piece = piece_on(board, square);
+            if (piece != no_piece) {
+                const char piece_chars[] = "PNBRQKpnbrqk";
+                piece_char = piece_chars[piece];
             }
             
             if (piece_char != ' ') {
@@ -189,8 +187,6 @@ int main(int argc, char* argv[]) {
     set_bit(white_pawns, g2);
     set_bit(white_pawns, h2);
     
-    init_leapers_attacks();
-    
     std::cout << "White Pawns:";
     print_bitboard(white_pawns);
 
@@ -241,15 +237,16 @@ int main(int argc, char* argv[]) {
     // Clear board
     for (int i = 0; i < 12; i++) board.bitboards[i] = 0ULL;
     for (int i = 0; i < 3; i++) board.occupancies[i] = 0ULL;
+    for (int i = 0; i < 64; i++) board.board[i] = no_piece;
     
     // Setup position
     // White King at e1, White Pawn at e2
-    set_bit(board.bitboards[K], e1);
-    set_bit(board.bitboards[P], e2);
+    set_bit(board.bitboards[K], e1); board.board[e1] = K;
+    set_bit(board.bitboards[P], e2); board.board[e2] = P;
     
     // Black King at e8, Black Pawn at d3 (capture target)
-    set_bit(board.bitboards[k], e8);
-    set_bit(board.bitboards[p], d3);
+    set_bit(board.bitboards[k], e8); board.board[e8] = k;
+    set_bit(board.bitboards[p], d3); board.board[d3] = p;
     
     board.side = 0; // White to move
     board.enpassant = no_sq;
@@ -24,7 +24,8 @@ enum {
 
 enum {
     P, N, B, R, Q, K, // White pieces
-    p, n, b, r, q, k  // Black pieces
+    p, n, b, r, q, k, // Black pieces
+    no_piece
 };
 
 // Bit manipulation macros/functions
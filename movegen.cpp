@@ -1,14 +1,15 @@
 #include "movegen.h"
 #include <iostream>
+#include <sstream>
 
 // Add move to list (helper)
-void add_move(Moves& move_list, int move) {
+static inline void add_move(Moves& move_list, Move move) {
     move_list.moves[move_list.count] = move;
     move_list.count++;
 }
 
-// Print move
-void print_move(int move) {
+// Move in UCI coordinate notation (e2e4, e7e8q)
+std::string move_to_uci(Move move) {
     const char* square_to_coordinates[] = {
         "a8", "b8", "c8", "d8", "e8", "f8", "g8", "h8",
         "a7", "b7", "c7", "d7", "e7", "f7", "g7", "h7",
@@ -20,15 +21,26 @@ void print_move(int move) {
         "a1", "b1", "c1", "d1", "e1", "f1", "g1", "h1"
     };
     
-    char promoted_pieces[] = { 'p', 'n', 'b', 'r', 'q', 'k', 'p', 'n', 'b', 'r', 'q', 'k' };
+    char promoted_pieces[] = { 'p', 'n', 'b', 'r', 'q', 'k' };
     
-    std::cout << square_to_coordinates[get_move_source(move)] <<
-                 square_to_coordinates[get_move_target(move)];
-                 
-    if (get_move_promoted(move)) {
-        int p = get_move_promoted(move);
-        std::cout << promoted_pieces[p];
+    std::string uci = std::string(square_to_coordinates[move_source(move)]) + square_to_coordinates[move_target(move)];
+    if (move_is_promotion(move)) uci += promoted_pieces[move_promoted_type(move)];
+    return uci;
+}
+
+// Legal move matching a UCI string, 0 if there is none
+Move parse_uci_move(const Board& board, const std::string& uci) {
+    Moves moves;
+    generate_legal_moves(board, moves);
+    for (int i = 0; i < moves.count; i++) {
+        if (move_to_uci(moves.moves[i]) == uci) return moves.moves[i];
     }
+    return 0;
+}
+
+// Print move
+void print_move(Move move) {
+    std::cout << move_to_uci(move);
 }
 
 void print_move_list(const Moves& moves) {
@@ -42,273 +54,373 @@ void print_move_list(const Moves& moves) {
 
 void generate_moves(const Board& board, Moves& moves) {
     moves.count = 0;
-    int source_square, target;
-    U64 bitboard, attacks;
-    
-    // Loop over all pieces
-    for (int piece = P; piece <= k; piece++) {
-        bitboard = board.bitboards[piece];
+    generate_moves(board, [&moves](Move move) { add_move(moves, move); return true; });
+}
+
+template <int Type>
+void generate(const Board& board, Moves& moves) {
+    moves.count = 0;
+    generate<Type>(board, [&moves](Move move) { add_move(moves, move); return true; });
+}
+
+template void generate<GEN_ALL>(const Board& board, Moves& moves);
+template void generate<GEN_CAPTURES>(const Board& board, Moves& moves);
+template void generate<GEN_QUIETS>(const Board& board, Moves& moves);
+template void generate<GEN_EVASIONS>(const Board& board, Moves& moves);
+template void generate<GEN_QUIET_CHECKS>(const Board& board, Moves& moves);
+
+void generate_legal_moves(const Board& board, Moves& moves) {
+    generate<GEN_ALL>(board, moves);
+}
+
+int count_legal_moves(const Board& board) {
+    MoveCounter counter;
+    generate<GEN_ALL>(board, counter);
+    return counter.count;
+}
+
+bool has_legal_move(const Board& board) {
+    // The visitor stops at the first move, so a stopped generation means one exists
+    return !generate<GEN_ALL>(board, [](Move) { return false; });
+}
+
+// Checks one move against the position with attack tables and occupancy,
+// accepting exactly the moves generate_moves would produce
+bool is_pseudo_legal(const Board& board, Move move) {
+    int source = move_source(move);
+    int target = move_target(move);
+    int flag = move_flag(move);
+    int side = board.side;
+    int piece = piece_on(board, source);
+    
+    if (piece == no_piece || piece / 6 != side) return false;
+    if (get_bit(board.occupancies[side], target)) return false;
+    if ((flag > EN_PASSANT && flag < PROMOTION_N) || flag > PROMOTION_Q) return false; // Unused flag values
+    
+    // Castling: king on its home square, right still held, path empty and safe
+    if (move_is_castling(move)) {
+        int offset = (side == 0) ? 0 : -56;
+        int king_side = (flag == KING_CASTLE);
+        if (piece % 6 != K || source != e1 + offset) return false;
+        if (target != (king_side ? g1 : c1) + offset) return false;
+        if (!(board.castle & (king_side ? 1 : 2) << (2 * side))) return false;
         
-        // Check if piece belongs to current side
-        if (board.side == 0) { // White
-            if (piece >= p) continue; // Skip black pieces
-        } else { // Black
-            if (piece < p) continue; // Skip white pieces
-        }
+        U64 empty = king_side ? (1ULL << (f1 + offset)) | (1ULL << (g1 + offset))
+                              : (1ULL << (d1 + offset)) | (1ULL << (c1 + offset)) | (1ULL << (b1 + offset));
+        if (board.occupancies[2] & empty) return false;
         
-        while (bitboard) {
-            // Get source square (LSB)
-            source_square = __builtin_ctzll(bitboard);
-            
-            // Generate moves for this piece
-            // Pawns
-            if (piece == P) { // White Pawn
-                // 1. Single Push
-                target = source_square - 8;
-                if (target >= 0 && !get_bit(board.occupancies[2], target)) {
-                     // Promotion (Rank 8 is a8-h8? No, Rank 8 is 0-7)
-                     if (source_square >= a7 && source_square <= h7) {
-                         add_move(moves, encode_move(source_square, target, piece, Q, 0, 0, 0, 0));
-                         add_move(moves, encode_move(source_square, target, piece, R, 0, 0, 0, 0));
-                         add_move(moves, encode_move(source_square, target, piece, B, 0, 0, 0, 0));
-                         add_move(moves, encode_move(source_square, target, piece, N, 0, 0, 0, 0));
-                     } else {
-                         add_move(moves, encode_move(source_square, target, piece, 0, 0, 0, 0, 0));
-                         // 2. Double Push (from Rank 2: 48-55)
-                         if ((source_square >= a2 && source_square <= h2) && !get_bit(board.occupancies[2], target - 8)) {
-                             add_move(moves, encode_move(source_square, target - 8, piece, 0, 0, 1, 0, 0));
-                         }
-                     }
-                }
-                
-                // 3. Captures
-                attacks = pawn_attacks[0][source_square] & board.occupancies[1]; // White pawns capture black
-                while (attacks) {
-                    target = __builtin_ctzll(attacks);
-                    if (source_square >= a7 && source_square <= h7) {
-                         add_move(moves, encode_move(source_square, target, piece, Q, 1, 0, 0, 0));
-                         add_move(moves, encode_move(source_square, target, piece, R, 1, 0, 0, 0));
-                         add_move(moves, encode_move(source_square, target, piece, B, 1, 0, 0, 0));
-                         add_move(moves, encode_move(source_square, target, piece, N, 1, 0, 0, 0));
-                    } else {
-                        add_move(moves, encode_move(source_square, target, piece, 0, 1, 0, 0, 0));
-                    }
-                    pop_bit(attacks, target);
-                }
-                
-            }
-            
-            else if (piece == p) { // Black Pawn
-                 // 1. Single Push (+8)
-                target = source_square + 8;
-                if (target < 64 && !get_bit(board.occupancies[2], target)) {
-                     // Promotion (Rank 1: 56-63)
-                     if (source_square >= a2 && source_square <= h2) { // 2nd rank from top (7th rank)
-                         add_move(moves, encode_move(source_square, target, piece, q, 0, 0, 0, 0));
-                         add_move(moves, encode_move(source_square, target, piece, r, 0, 0, 0, 0));
-                         add_move(moves, encode_move(source_square, target, piece, b, 0, 0, 0, 0));
-                         add_move(moves, encode_move(source_square, target, piece, n, 0, 0, 0, 0));
-                     } else {
-                         add_move(moves, encode_move(source_square, target, piece, 0, 0, 0, 0, 0));
-                         // 2. Double Push (from Rank 7: 8-15)
-                         if ((source_square >= a7 && source_square <= h7) && !get_bit(board.occupancies[2], target + 8)) {
-                             add_move(moves, encode_move(source_square, target + 8, piece, 0, 0, 1, 0, 0));
-                         }
-                     }
-                }
-                
-                // 3. Captures
-                attacks = pawn_attacks[1][source_square] & board.occupancies[0]; // Black pawns capture white
-                while (attacks) {
-                    target = __builtin_ctzll(attacks);
-                    if (source_square >= a2 && source_square <= h2) {
-                         add_move(moves, encode_move(source_square, target, piece, q, 1, 0, 0, 0));
-                         add_move(moves, encode_move(source_square, target, piece, r, 1, 0, 0, 0));
-                         add_move(moves, encode_move(source_square, target, piece, b, 1, 0, 0, 0));
-                         add_move(moves, encode_move(source_square, target, piece, n, 1, 0, 0, 0));
-                    } else {
-                        add_move(moves, encode_move(source_square, target, piece, 0, 1, 0, 0, 0));
-                    }
-                    pop_bit(attacks, target);
-                }
-            }
-            
-            else { // Other pieces
-                if (piece == N || piece == n) attacks = knight_attacks[source_square];
-                else if (piece == B || piece == b) attacks = get_bishop_attacks(source_square, board.occupancies[2]);
-                else if (piece == R || piece == r) attacks = get_rook_attacks(source_square, board.occupancies[2]);
-                else if (piece == Q || piece == q) attacks = get_queen_attacks(source_square, board.occupancies[2]);
-                else if (piece == K || piece == k) attacks = king_attacks[source_square];
-                
-                // Filter attacks: can only move to squares NOT occupied by own side
-                attacks &= ~board.occupancies[board.side];
-                
-                while (attacks) {
-                    target = __builtin_ctzll(attacks);
-                    
-                    // Capture logic
-                    int capture = 0;
-                    if (get_bit(board.occupancies[1 - board.side], target)) capture = 1;
-                    
-                    add_move(moves, encode_move(source_square, target, piece, 0, capture, 0, 0, 0));
-                    
-                    pop_bit(attacks, target);
-                }
-            }
-            
-            // Pop the source bit to move to next piece
-            pop_bit(bitboard, source_square);
+        int step = king_side ? 1 : -1;
+        for (int square = source; square != target + step; square += step) {
+            if (attackers_to(square, board.occupancies[2], board.bitboards) & board.occupancies[side ^ 1]) return false;
         }
+        return true;
     }
     
-    // Castling
-    if (board.side == 0) { // White Castling
-        // King side (e1 -> g1)
-        if ((board.castle & 1) && !get_bit(board.occupancies[2], f1) && !get_bit(board.occupancies[2], g1)) {
-            // Check attacks (e1, f1, g1 must not be attacked)
-            if (!is_square_attacked(e1, 1, (U64*)board.bitboards, (U64*)board.occupancies) &&
-                !is_square_attacked(f1, 1, (U64*)board.bitboards, (U64*)board.occupancies) &&
-                !is_square_attacked(g1, 1, (U64*)board.bitboards, (U64*)board.occupancies)) {
-                    add_move(moves, encode_move(e1, g1, K, 0, 0, 0, 0, 1));
-            }
-        }
-        // Queen side (e1 -> c1)
-        if ((board.castle & 2) && !get_bit(board.occupancies[2], d1) && !get_bit(board.occupancies[2], c1) && !get_bit(board.occupancies[2], b1)) {
-            if (!is_square_attacked(e1, 1, (U64*)board.bitboards, (U64*)board.occupancies) &&
-                !is_square_attacked(d1, 1, (U64*)board.bitboards, (U64*)board.occupancies) &&
-                // c1 check not required by FIDE rules? "squares that the king passes over or lands on".
-                // King moves e1->d1->c1. So d1 and c1 must be safe. b1 is irrelevant to King path (rook moves over it)
-                !is_square_attacked(c1, 1, (U64*)board.bitboards, (U64*)board.occupancies)) {
-                    add_move(moves, encode_move(e1, c1, K, 0, 0, 0, 0, 1));
-            }
+    if (piece % 6 != P) {
+        // Pieces only make plain moves and captures
+        if (flag != QUIET) return false;
+        switch (piece % 6) {
+            case N: return get_bit(knight_attacks[source], target);
+            case B: return get_bit(get_bishop_attacks(source, board.occupancies[2]), target);
+            case R: return get_bit(get_rook_attacks(source, board.occupancies[2]), target);
+            case Q: return get_bit(get_queen_attacks(source, board.occupancies[2]), target);
+            default: return get_bit(king_attacks[source], target);
         }
     }
-    else { // Black Castling
-        // King side (e8 -> g8)
-        if ((board.castle & 4) && !get_bit(board.occupancies[2], f8) && !get_bit(board.occupancies[2], g8)) {
-            if (!is_square_attacked(e8, 0, (U64*)board.bitboards, (U64*)board.occupancies) &&
-                !is_square_attacked(f8, 0, (U64*)board.bitboards, (U64*)board.occupancies) &&
-                !is_square_attacked(g8, 0, (U64*)board.bitboards, (U64*)board.occupancies)) {
-                    add_move(moves, encode_move(e8, g8, k, 0, 0, 0, 0, 1));
-            }
-        }
-        // Queen side (e8 -> c8)
-        if ((board.castle & 8) && !get_bit(board.occupancies[2], d8) && !get_bit(board.occupancies[2], c8) && !get_bit(board.occupancies[2], b8)) {
-            if (!is_square_attacked(e8, 0, (U64*)board.bitboards, (U64*)board.occupancies) &&
-                !is_square_attacked(d8, 0, (U64*)board.bitboards, (U64*)board.occupancies) &&
-                !is_square_attacked(c8, 0, (U64*)board.bitboards, (U64*)board.occupancies)) {
-                    add_move(moves, encode_move(e8, c8, k, 0, 0, 0, 0, 1));
-            }
-        }
+    
+    int push = pawn_push_of(side);
+    int last_rank = (side == 0) ? (target < 8) : (target >= 56);
+    
+    if (flag == EN_PASSANT) return target == board.enpassant && get_bit(pawn_attacks[side][source], target);
+    if (flag == DOUBLE_PUSH) {
+        return source / 8 == ((side == 0) ? 6 : 1) && target == source + 2 * push &&
+               !get_bit(board.occupancies[2], source + push) && !get_bit(board.occupancies[2], target);
     }
+    
+    // Promotion exactly when reaching the last rank
+    if (move_is_promotion(move) != (last_rank != 0)) return false;
+    
+    // Push onto an empty square, or capture an enemy piece
+    if (target == source + push) return !get_bit(board.occupancies[2], target);
+    return get_bit(pawn_attacks[side][source], target) && get_bit(board.occupancies[side ^ 1], target);
 }
 
-// Make move
-int make_move(Board& board, int move, int capture_flag) {
-    if (capture_flag) {
-        // Remove captured piece
-        int target = get_move_target(move);
-        int start_piece, end_piece;
-        
-        if (board.side == 0) { // White captures Black
-            start_piece = p; end_piece = k;
-        } else { // Black captures White
-            start_piece = P; end_piece = K;
-        }
-        
-        for (int bb_piece = start_piece; bb_piece <= end_piece; bb_piece++) {
-            if (get_bit(board.bitboards[bb_piece], target)) {
-                pop_bit(board.bitboards[bb_piece], target);
-                break;
-            }
-        }
+// Assumes a pseudo-legal move; tests king safety without making the move
+bool is_legal(const Board& board, Move move) {
+    int side = board.side;
+    U64 king = board.bitboards[(side == 0) ? K : k];
+    if (!king) return true;
+    
+    int source = move_source(move);
+    int target = move_target(move);
+    int king_sq = __builtin_ctzll(king);
+    U64 enemy = board.occupancies[side ^ 1];
+    
+    // Castling squares were already tested for attacks
+    if (move_is_castling(move)) return true;
+    
+    // King moves: target square not attacked once the king has left its square
+    if (source == king_sq) {
+        return !(attackers_to(target, board.occupancies[2] ^ king, board.bitboards) & enemy);
     }
+    
+    // En passant: both pawns leave their squares, test the king on the new occupancy
+    if (move_is_enpassant(move)) {
+        U64 captured = 1ULL << (target - pawn_push_of(side));
+        U64 after = board.occupancies[2] ^ (1ULL << source) ^ captured ^ (1ULL << target);
+        return !(attackers_to(king_sq, after, board.bitboards) & enemy & ~captured);
+    }
+    
+    // A pinned piece must stay on the line through its king
+    if (get_bit(pinned_pieces(board, side), source) && !get_bit(line[king_sq][source], target)) return false;
+    
+    // In check: capture the checker or block it; double check needs a king move
+    U64 check = checkers(board);
+    if (!check) return true;
+    if (check & (check - 1)) return false;
+    return get_bit(check | between[king_sq][__builtin_ctzll(check)], target) != 0;
+}
+
+// Zobrist keys from a fixed-seed xorshift generator, built at compile time
+struct ZobristKeys {
+    U64 pieces[12][64];
+    U64 enpassant[64];
+    U64 castle[16];
+    U64 side;
+};
 
-    // Move piece
-    int piece = get_move_piece(move);
-    int source = get_move_source(move);
-    int target = get_move_target(move);
+constexpr ZobristKeys init_zobrist() {
+    ZobristKeys keys{};
+    U64 state = 1070372ULL;
+    auto next = [&state]() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 2685821657736338717ULL;
+    };
     
-    // Check bounds
-    if (piece < 0 || piece > 11) { std::cout << "Invalid piece " << piece << "\n"; return 0; }
-    if (source < 0 || source > 63) { std::cout << "Invalid source " << source << "\n"; return 0; }
-    if (target < 0 || target > 63) { std::cout << "Invalid target " << target << "\n"; return 0; }
+    for (int piece = P; piece <= k; piece++) {
+        for (int square = 0; square < 64; square++) keys.pieces[piece][square] = next();
+    }
+    for (int square = 0; square < 64; square++) keys.enpassant[square] = next();
+    for (int rights = 0; rights < 16; rights++) keys.castle[rights] = next();
+    keys.side = next();
     
-    pop_bit(board.bitboards[piece], source);
-    set_bit(board.bitboards[piece], target);
-    
-    // Promotion
-    int promoted = get_move_promoted(move);
-    if (promoted) {
-        if (promoted < 0 || promoted > 11) { std::cout << "Invalid promoted " << promoted << "\n"; return 0; }
-        pop_bit(board.bitboards[piece], target); // Remove Pawn
-        set_bit(board.bitboards[promoted], target); // Add Promoted Piece
-    }
-    
-    // En Passant
-    if (get_move_enpassant(move)) {
-        if (board.side == 0) { // White En Passant
-             pop_bit(board.bitboards[p], target + 8);
-        } else { // Black En Passant
-             pop_bit(board.bitboards[P], target - 8);
+    return keys;
+}
+
+static constexpr ZobristKeys zobrist = init_zobrist();
+
+U64 compute_hash(const Board& board) {
+    U64 hash = 0ULL;
+    
+    for (int piece = P; piece <= k; piece++) {
+        U64 bitboard = board.bitboards[piece];
+        while (bitboard) {
+            int square = __builtin_ctzll(bitboard);
+            hash ^= zobrist.pieces[piece][square];
+            pop_bit(bitboard, square);
         }
     }
+    if (board.enpassant != no_sq) hash ^= zobrist.enpassant[board.enpassant];
+    hash ^= zobrist.castle[board.castle];
+    if (board.side) hash ^= zobrist.side;
+    
+    return hash;
+}
+
+// Castling rights kept after a move touches a square: moving or capturing
+// on a king or rook home square clears the matching rights (1=WK, 2=WQ,
+// 4=BK, 8=BQ)
+static constexpr std::array<int, 64> init_castling_rights() {
+    std::array<int, 64> rights{};
+    for (int square = 0; square < 64; square++) rights[square] = 15;
+    rights[a8] = 15 & ~8;
+    rights[e8] = 15 & ~12;
+    rights[h8] = 15 & ~4;
+    rights[a1] = 15 & ~2;
+    rights[e1] = 15 & ~3;
+    rights[h1] = 15 & ~1;
+    return rights;
+}
+
+static constexpr std::array<int, 64> castling_rights = init_castling_rights();
+
+// Castling rook squares for a king target square [from, to]
+static inline void castling_rook(int target, int& rook_from, int& rook_to) {
+    switch (target) {
+        case g1: rook_from = h1; rook_to = f1; break; // White King Slide
+        case c1: rook_from = a1; rook_to = d1; break; // White Queen Slide
+        case g8: rook_from = h8; rook_to = f8; break; // Black King Slide
+        default: rook_from = a8; rook_to = d8; break; // Black Queen Slide
+    }
+}
+
+void init_check_info(const Board& board, CheckInfo& info) {
+    int side = board.side;
+    U64 enemy_king = board.bitboards[(side == 0) ? k : K];
+    if (!enemy_king) {
+        for (int piece = P; piece <= K; piece++) info.check_squares[piece] = 0ULL;
+        info.discoverers = 0ULL;
+        info.king_square = no_sq;
+        return;
+    }
+    
+    int king_sq = __builtin_ctzll(enemy_king);
+    U64 occupancy = board.occupancies[2];
+    
+    // A piece checks from the squares it would attack if it stood on the
+    // king square (pawns looked up with the enemy's attack direction)
+    info.check_squares[P] = pawn_attacks[side ^ 1][king_sq];
+    info.check_squares[N] = knight_attacks[king_sq];
+    info.check_squares[B] = get_bishop_attacks(king_sq, occupancy);
+    info.check_squares[R] = get_rook_attacks(king_sq, occupancy);
+    info.check_squares[Q] = info.check_squares[B] | info.check_squares[R];
+    info.check_squares[K] = 0ULL;
+    info.discoverers = discovered_check_candidates(board, side);
+    info.king_square = king_sq;
+}
+
+bool gives_check(const Board& board, Move move, const CheckInfo& info) {
+    if (info.king_square == no_sq) return false;
+    
+    int side = board.side;
+    int source = move_source(move);
+    int target = move_target(move);
+    int king_sq = info.king_square;
+    U64 occupancy = board.occupancies[2];
+    
+    // Direct check from the target square
+    if (!move_is_promotion(move) && !move_is_castling(move)) {
+        if (get_bit(info.check_squares[piece_on(board, source) % 6], target)) return true;
+    }
+    
+    // Discovered check: a blocker leaves the line to the king
+    if (get_bit(info.discoverers, source) && !get_bit(line[king_sq][source], target)) return true;
+    
+    if (move_is_promotion(move)) {
+        // The new piece attacks from the target with the pawn gone from its
+        // square (which may have stood between the target and the king)
+        int promoted = move_promoted_type(move);
+        U64 after = occupancy ^ (1ULL << source);
+        U64 attacks = (promoted == N) ? knight_attacks[target]
+                    : (promoted == B) ? get_bishop_attacks(target, after)
+                    : (promoted == R) ? get_rook_attacks(target, after)
+                    : get_queen_attacks(target, after);
+        return get_bit(attacks, king_sq) != 0;
+    }
+    
+    if (move_is_enpassant(move)) {
+        // Removing the captured pawn can uncover a slider as well, also
+        // along the rank both pawns shared
+        U64 after = occupancy ^ (1ULL << source) ^ (1ULL << (target - pawn_push_of(side))) ^ (1ULL << target);
+        U64 rook_queen = (side == 0) ? (board.bitboards[R] | board.bitboards[Q]) : (board.bitboards[r] | board.bitboards[q]);
+        U64 bishop_queen = (side == 0) ? (board.bitboards[B] | board.bitboards[Q]) : (board.bitboards[b] | board.bitboards[q]);
+        return (get_rook_attacks(king_sq, after) & rook_queen) || (get_bishop_attacks(king_sq, after) & bishop_queen);
+    }
+    
+    if (move_is_castling(move)) {
+        // The rook checks from its new square once king and rook have moved
+        int rook_from, rook_to;
+        castling_rook(target, rook_from, rook_to);
+        U64 after = occupancy ^ (1ULL << source) ^ (1ULL << target) ^ (1ULL << rook_from) ^ (1ULL << rook_to);
+        return get_bit(get_rook_attacks(rook_to, after), king_sq) != 0;
+    }
+    
+    return false;
+}
+
+bool gives_check(const Board& board, Move move) {
+    CheckInfo info;
+    init_check_info(board, info);
+    return gives_check(board, move, info);
+}
+
+// Apply a move to the board without testing king safety, saving what
+// unmake_move needs in undo. Every bitboard, the mailbox and the hash are
+// updated incrementally from the squares the move touches.
+// Returns 0 if there is no piece of the side to move on the source square
+// (only checked in MOVEGEN_DEBUG builds)
+static int apply_move(Board& board, Move move, Undo& undo) {
+    int source = move_source(move);
+    int target = move_target(move);
+    int side = board.side;
+    int first = (side == 0) ? P : p;
+    int piece = board.board[source];
+    
+#ifdef MOVEGEN_DEBUG
+    if (piece == no_piece || piece / 6 != side) { std::cout << "Invalid move: no piece on source " << source << "\n"; return 0; }
+#endif
+    
+    undo.captured = no_piece;
+    undo.castle = board.castle;
+    undo.enpassant = board.enpassant;
+    undo.rule50 = board.rule50;
+    undo.hash = board.hash;
+    
+    // Captured piece (en passant takes the pawn behind the target square)
+    int captured_square = move_is_enpassant(move) ? target - pawn_push_of(side) : target;
+    if (board.board[captured_square] != no_piece) {
+        undo.captured = board.board[captured_square];
+        pop_bit(board.bitboards[undo.captured], captured_square);
+        board.occupancies[side ^ 1] ^= 1ULL << captured_square;
+        board.board[captured_square] = no_piece;
+        board.hash ^= zobrist.pieces[undo.captured][captured_square];
+    }
+
+    // Move piece (a promotion lands as the promoted piece)
+    int landing = move_is_promotion(move) ? move_promoted_type(move) + first : piece;
+    pop_bit(board.bitboards[piece], source);
+    set_bit(board.bitboards[landing], target);
+    board.occupancies[side] ^= (1ULL << source) | (1ULL << target);
+    board.board[source] = no_piece;
+    board.board[target] = landing;
+    board.hash ^= zobrist.pieces[piece][source] ^ zobrist.pieces[landing][target];
     
     // Update En Passant Target
+    if (board.enpassant != no_sq) board.hash ^= zobrist.enpassant[board.enpassant];
     board.enpassant = no_sq;
-    if (get_move_double(move)) {
-        if (board.side == 0) board.enpassant = target + 8;
-        else board.enpassant = target - 8;
+    if (move_is_double_push(move)) {
+        board.enpassant = target - pawn_push_of(side);
+        board.hash ^= zobrist.enpassant[board.enpassant];
     }
     
     // Castling
-    if (get_move_castling(move)) {
-        if (target == g1) { // White King Slide
-            pop_bit(board.bitboards[R], h1);
-            set_bit(board.bitboards[R], f1);
-        }
-        else if (target == c1) { // White Queen Slide
-            pop_bit(board.bitboards[R], a1);
-            set_bit(board.bitboards[R], d1);
-        }
-        else if (target == g8) { // Black King Slide
-            pop_bit(board.bitboards[r], h8);
-            set_bit(board.bitboards[r], f8);
-        }
-        else if (target == c8) { // Black Queen Slide
-            pop_bit(board.bitboards[r], a8);
-            set_bit(board.bitboards[r], d8);
-        }
+    if (move_is_castling(move)) {
+        int rook = first + R;
+        int rook_from, rook_to;
+        castling_rook(target, rook_from, rook_to);
+        pop_bit(board.bitboards[rook], rook_from);
+        set_bit(board.bitboards[rook], rook_to);
+        board.occupancies[side] ^= (1ULL << rook_from) | (1ULL << rook_to);
+        board.board[rook_from] = no_piece;
+        board.board[rook_to] = rook;
+        board.hash ^= zobrist.pieces[rook][rook_from] ^ zobrist.pieces[rook][rook_to];
     }
     
     // Update Castling Rights
-    // If King moves, loose rights. If Rook moves/captured, loose rights.
-    // Simple robust update:
-    // Mask based on source/target.
-    // 1=WK, 2=WQ, 4=BK, 8=BQ.
-    // Maps: e1->~3, e8->~12. a1->~2, h1->~1. a8->~8, h8->~4.
-    // Using simple if statements for clarity.
-    
-    // Only update if rights exist
-    if (board.castle) {
-        if (source == e1 || target == e1) board.castle &= ~3;
-        if (source == e8 || target == e8) board.castle &= ~12;
-        
-        if (source == h1 || target == h1) board.castle &= ~1;
-        if (source == a1 || target == a1) board.castle &= ~2;
-        if (source == h8 || target == h8) board.castle &= ~4;
-        if (source == a8 || target == a8) board.castle &= ~8;
-    }
+    board.hash ^= zobrist.castle[board.castle];
+    board.castle &= castling_rights[source] & castling_rights[target];
+    board.hash ^= zobrist.castle[board.castle];
+    
+    // Move counters: the 50 move clock restarts on pawn moves and captures
+    if (piece == first || undo.captured != no_piece) board.rule50 = 0;
+    else board.rule50++;
+    if (side == 1) board.fullmove++;
     
-    // Update Occupancies
-    board.occupancies[0] = 0ULL;
-    board.occupancies[1] = 0ULL;
-    for (int i = P; i <= K; i++) board.occupancies[0] |= board.bitboards[i];
-    for (int i = p; i <= k; i++) board.occupancies[1] |= board.bitboards[i];
     board.occupancies[2] = board.occupancies[0] | board.occupancies[1];
     
     // Change Side
     board.side ^= 1;
+    board.hash ^= zobrist.side;
+    
+    return 1;
+}
+
+// Make move
+int make_move(Board& board, Move move) {
+    Undo undo;
+    if (!apply_move(board, move, undo)) return 0;
     
     // Check for Legality (King safety)
     int king_sq = -1;
@@ -323,11 +435,138 @@ int make_move(Board& board, int move, int capture_flag) {
     return 1;
 }
 
+// Make a move known to be legal (from generate_legal_moves)
+void make_legal_move(Board& board, Move move) {
+    Undo undo;
+    apply_move(board, move, undo);
+}
+
+void make_legal_move(Board& board, Move move, Undo& undo) {
+    apply_move(board, move, undo);
+}
+
+// Take back a move made with make_legal_move(board, move, undo)
+void unmake_move(Board& board, Move move, const Undo& undo) {
+    board.side ^= 1;
+    
+    int source = move_source(move);
+    int target = move_target(move);
+    int side = board.side;
+    int first = (side == 0) ? P : p;
+    
+    // Move piece back (a promoted piece turns back into a pawn)
+    int landing = board.board[target];
+    int piece = move_is_promotion(move) ? first : landing;
+    pop_bit(board.bitboards[landing], target);
+    set_bit(board.bitboards[piece], source);
+    board.occupancies[side] ^= (1ULL << source) | (1ULL << target);
+    board.board[target] = no_piece;
+    board.board[source] = piece;
+    
+    // Restore captured piece
+    if (undo.captured != no_piece) {
+        int captured_square = move_is_enpassant(move) ? target - pawn_push_of(side) : target;
+        set_bit(board.bitboards[undo.captured], captured_square);
+        board.occupancies[side ^ 1] ^= 1ULL << captured_square;
+        board.board[captured_square] = undo.captured;
+    }
+    
+    // Move castling rook back
+    if (move_is_castling(move)) {
+        int rook = first + R;
+        int rook_from, rook_to;
+        castling_rook(target, rook_from, rook_to);
+        pop_bit(board.bitboards[rook], rook_to);
+        set_bit(board.bitboards[rook], rook_from);
+        board.occupancies[side] ^= (1ULL << rook_from) | (1ULL << rook_to);
+        board.board[rook_to] = no_piece;
+        board.board[rook_from] = rook;
+    }
+    
+    board.occupancies[2] = board.occupancies[0] | board.occupancies[1];
+    board.castle = undo.castle;
+    board.enpassant = undo.enpassant;
+    board.rule50 = undo.rule50;
+    board.hash = undo.hash;
+    if (side == 1) board.fullmove--;
+}
+
+// Check a FEN before handing it to parse_fen, which trusts its input:
+// eight ranks of eight squares, side to move, castling rights and en
+// passant square are required, the two move counters are optional
+bool is_valid_fen(const std::string& fen) {
+    std::stringstream fields(fen);
+    std::string placement, side, castling, enpassant, rule50, fullmove, extra;
+    if (!(fields >> placement >> side >> castling >> enpassant)) return false;
+    if ((fields >> rule50) && rule50.find_first_not_of("0123456789") != std::string::npos) return false;
+    if ((fields >> fullmove) && fullmove.find_first_not_of("0123456789") != std::string::npos) return false;
+    if (fields >> extra) return false;
+    
+    // Piece placement into a square array (a8 = 0), '.' for empty squares
+    char squares[64];
+    int rank = 0, file = 0;
+    for (char c : placement) {
+        if (c == '/') {
+            if (file != 8 || rank == 7) return false;
+            rank++;
+            file = 0;
+        } else if (c >= '1' && c <= '8') {
+            if (file + (c - '0') > 8) return false;
+            for (int i = 0; i < c - '0'; i++) squares[rank * 8 + file++] = '.';
+        } else if (std::string("PNBRQKpnbrqk").find(c) != std::string::npos) {
+            if (file == 8) return false;
+            squares[rank * 8 + file++] = c;
+        } else {
+            return false;
+        }
+    }
+    if (rank != 7 || file != 8) return false;
+    
+    // One king per side, no pawns on the back ranks
+    int white_kings = 0, black_kings = 0;
+    for (int square = 0; square < 64; square++) {
+        white_kings += (squares[square] == 'K');
+        black_kings += (squares[square] == 'k');
+        if ((square < 8 || square >= 56) && (squares[square] == 'P' || squares[square] == 'p')) return false;
+    }
+    if (white_kings != 1 || black_kings != 1) return false;
+    
+    if (side != "w" && side != "b") return false;
+    
+    // Each castling right needs its king and rook on their home squares
+    if (castling != "-") {
+        if (castling.find_first_not_of("KQkq") != std::string::npos) return false;
+        for (char right : castling) {
+            bool ok = (right == 'K') ? (squares[e1] == 'K' && squares[h1] == 'R')
+                    : (right == 'Q') ? (squares[e1] == 'K' && squares[a1] == 'R')
+                    : (right == 'k') ? (squares[e8] == 'k' && squares[h8] == 'r')
+                    : (squares[e8] == 'k' && squares[a8] == 'r');
+            if (!ok) return false;
+        }
+    }
+    
+    // En passant square: behind a pawn the opponent just pushed two squares,
+    // so rank 6 with white to move and rank 3 with black to move
+    if (enpassant != "-") {
+        if (enpassant.size() != 2 || enpassant[0] < 'a' || enpassant[0] > 'h') return false;
+        if (enpassant[1] != (side == "w" ? '6' : '3')) return false;
+        int square = (8 - (enpassant[1] - '0')) * 8 + (enpassant[0] - 'a');
+        int pushed = (side == "w") ? square + 8 : square - 8;
+        if (squares[square] != '.' || squares[pushed] != (side == "w" ? 'p' : 'P')) return false;
+    }
+    return true;
+}
+
 // Parse FEN
 void parse_fen(char* fen, Board& board) {
+    // Cold path every position goes through: make sure the slider tables
+    // exist even when called from a static initializer
+    init_slider_attacks();
+    
     // Clear board
     for (int i = 0; i < 12; i++) board.bitboards[i] = 0ULL;
     for (int i = 0; i < 3; i++) board.occupancies[i] = 0ULL;
+    for (int i = 0; i < 64; i++) board.board[i] = no_piece;
     board.side = 0;
     board.enpassant = no_sq;
     board.castle = 0;
@@ -356,7 +595,10 @@ void parse_fen(char* fen, Board& board) {
                 case 'k': piece = k; break;
             }
             
-            if (piece != -1) set_bit(board.bitboards[piece], square);
+            if (piece != -1) {
+                set_bit(board.bitboards[piece], square);
+                board.board[square] = piece;
+            }
             file++;
         }
         else if (*fen >= '0' && *fen <= '9') {
@@ -393,12 +635,12 @@ void parse_fen(char* fen, Board& board) {
     // Parse Side to Move
     if (*fen == 'w') board.side = 0;
     else board.side = 1;
-    fen++;
+    if (*fen) fen++;
     
     while (*fen == ' ') fen++;
     
     // Parse Castling
-    while (*fen != ' ') {
+    while (*fen && *fen != ' ') {
         switch (*fen) {
             case 'K': board.castle |= 1; break;
             case 'Q': board.castle |= 2; break;
@@ -408,17 +650,17 @@ void parse_fen(char* fen, Board& board) {
         }
         fen++;
     }
-    fen++;
+    if (*fen) fen++;
     
     // EP parsing
-    if (*fen != '-') {
+    if (*fen && *fen != '-') {
         int file = fen[0] - 'a';
         int rank = 8 - (fen[1] - '0');
         board.enpassant = rank * 8 + file;
         fen += 2;
     } else {
         board.enpassant = no_sq;
-        fen++;
+        if (*fen) fen++;
     }
     
     // Halfmove & Fullmove
@@ -438,6 +680,8 @@ void parse_fen(char* fen, Board& board) {
      if (*fen >= '0' && *fen <= '9') {
         board.fullmove = atoi(fen);
     }
+    
+    board.hash = compute_hash(board);
 }
 
 // Generate FEN from board
@@ -447,17 +691,9 @@ std::string board_to_fen(const Board& board) {
     
     for (int rank = 0; rank < 8; rank++) {
         for (int file = 0; file < 8; file++) {
-            int square = rank * 8 + file;
-            int piece = -1;
-            
-            for (int p = P; p <= k; p++) {
-                if (get_bit(board.bitboards[p], square)) {
-                    piece = p;
-                    break;
-                }
-            }
+            int piece = piece_on(board, rank * 8 + file);
             
-            if (piece == -1) {
+            if (piece == no_piece) {
                 empty_count++;
             } else {
                 if (empty_count > 0) {
@@ -4,7 +4,8 @@
 #include "bitboard.h"
 #include "attacks.h"
 
-// Move encoding
+// Legacy 24-bit move encoding (kept for compatibility, the generator
+// produces the 16-bit Move below)
 // 0000 0000 0000 0000 0011 1111    Source Square (0-63)
 // 0000 0000 0000 1111 1100 0000    Target Square (0-63)
 // 0000 0000 1111 0000 0000 0000    Piece (0-11)
@@ -33,10 +34,34 @@
 #define get_move_enpassant(move) ((move) & 0x400000)
 #define get_move_castling(move) ((move) & 0x800000)
 
-// Move List
+// Compact move: the moving and captured pieces are read from the mailbox
+// 0000 0000 0011 1111    Source Square (0-63)
+// 0000 1111 1100 0000    Target Square (0-63)
+// 1111 0000 0000 0000    Flag (see below)
+typedef uint16_t Move;
+
+// Move flags: bit 3 = promotion, low bits = promoted piece. Captures carry
+// no flag of their own, see is_capture.
+enum {
+    QUIET, DOUBLE_PUSH, KING_CASTLE, QUEEN_CASTLE, EN_PASSANT,
+    PROMOTION_N = 8, PROMOTION_B, PROMOTION_R, PROMOTION_Q
+};
+
+constexpr Move new_move(int source, int target, int flag) { return (Move)(source | (target << 6) | (flag << 12)); }
+constexpr int move_source(Move move) { return move & 0x3f; }
+constexpr int move_target(Move move) { return (move >> 6) & 0x3f; }
+constexpr int move_flag(Move move) { return move >> 12; }
+constexpr bool move_is_promotion(Move move) { return move & 0x8000; }
+constexpr bool move_is_enpassant(Move move) { return move_flag(move) == EN_PASSANT; }
+constexpr bool move_is_double_push(Move move) { return move_flag(move) == DOUBLE_PUSH; }
+constexpr bool move_is_castling(Move move) { return move_flag(move) == KING_CASTLE || move_flag(move) == QUEEN_CASTLE; }
+// Promoted piece type as a white piece (N, B, R or Q)
+constexpr int move_promoted_type(Move move) { return N + (move_flag(move) & 3); }
+
+// Move List (514 bytes)
 typedef struct {
-    int moves[256];
-    int count;
+    Move moves[256];
+    uint16_t count;
 } Moves;
 
 // Board state for move generation (needs to be defined or we use a context)
@@ -52,22 +77,106 @@ typedef struct {
 struct Board {
     U64 bitboards[12];
     U64 occupancies[3]; // [white, black, both]
+    uint8_t board[64]; // Mailbox: piece on each square, no_piece if empty
     int side; // 0=white, 1=black
     int enpassant; // square, or no_sq
     int castle; // bitmask: 1=WK, 2=WQ, 4=BK, 8=BQ (example)
     int rule50; // Halfmove clock
     int fullmove; // Fullmove number
+    U64 hash; // Zobrist key
+};
+
+// Piece on a square, no_piece if empty
+inline int piece_on(const Board& board, int square) { return board.board[square]; }
+// Does a move capture on this board (en passant included)
+inline bool is_capture(const Board& board, Move move) {
+    return board.board[move_target(move)] != no_piece || move_is_enpassant(move);
+}
+
+// State a move destroys, saved by make_legal_move for unmake_move
+struct Undo {
+    int captured; // Captured piece, no_piece if none
+    int castle;
+    int enpassant;
+    int rule50;
+    U64 hash;
+};
+
+// What the side to move needs to know to tell whether a move gives check,
+// computed once per position: the squares from which each piece type would
+// attack the enemy king, and the pieces that uncover a check by moving off
+// the line between one of our sliders and that king.
+struct CheckInfo {
+    U64 check_squares[6]; // [P..K], empty for the king (it cannot give check)
+    U64 discoverers;
+    int king_square; // Enemy king, no_sq if there is none
+};
+
+// Generation modes (template parameter of generate)
+enum {
+    GEN_ALL,          // All legal moves
+    GEN_CAPTURES,     // Captures, en passant and promotions (quiet promotions included)
+    GEN_QUIETS,       // Non-capturing, non-promoting moves, castling included
+    GEN_EVASIONS,     // All legal moves when in check, nothing otherwise
+    GEN_QUIET_CHECKS  // Quiet moves that give direct or discovered check
 };
 
 // Functions
+// Pseudo-legal moves (may leave the king in check, make_move filters them)
 void generate_moves(const Board& board, Moves& moves);
+// Legal moves only (check evasion and pin masks applied during generation)
+void generate_legal_moves(const Board& board, Moves& moves);
+// Legal moves of one generation mode, e.g. generate<GEN_CAPTURES>(board, moves)
+template <int Type>
+void generate(const Board& board, Moves& moves);
+
+// Visitor API: visit(Move) is called for each move instead of filling a
+// Moves list, and returns false to stop generation early. Both return false
+// when the visitor stopped them.
+// e.g. generate<GEN_ALL>(board, [&](Move move) { count++; return true; });
+template <typename Visitor>
+bool generate_moves(const Board& board, Visitor&& visit); // Pseudo-legal
+template <int Type, typename Visitor>
+bool generate(const Board& board, Visitor&& visit);       // Legal, one mode
+// Number of legal moves, popcounting target sets without encoding moves
+int count_legal_moves(const Board& board);
+// At least one legal move (not mate or stalemate); stops at the first move
+bool has_legal_move(const Board& board);
+
+// Single move checks for moves from outside the generator (hash, killers, book):
+// could generate_moves produce it here, and does it keep the king safe
+// (is_legal expects a pseudo-legal move)
+bool is_pseudo_legal(const Board& board, Move move);
+bool is_legal(const Board& board, Move move);
+
+// Does a legal move give check, answered before it is played
+void init_check_info(const Board& board, CheckInfo& info);
+bool gives_check(const Board& board, Move move, const CheckInfo& info);
+bool gives_check(const Board& board, Move move); // Builds the CheckInfo itself
+
 // Returns 0 if move is illegal (leaves king in check), 1 otherwise
-int make_move(Board& board, int move, int capture_flag);
-void print_move(int move);
+int make_move(Board& board, Move move);
+// Make a move from generate_legal_moves, skipping the king safety test
+void make_legal_move(Board& board, Move move);
+// Same, saving the state unmake_move needs to take the move back
+void make_legal_move(Board& board, Move move, Undo& undo);
+void unmake_move(Board& board, Move move, const Undo& undo);
+// Zobrist key of a position from scratch (make/unmake update it incrementally)
+U64 compute_hash(const Board& board);
+void print_move(Move move);
+std::string move_to_uci(Move move);
+// Legal move matching a UCI string (e2e4, e7e8q), 0 if there is none
+Move parse_uci_move(const Board& board, const std::string& uci);
 void print_move_list(const Moves& moves);
 
-// FEN parsing (minimal helper for perft tests)
+// FEN parsing (minimal helper for perft tests). parse_fen trusts its input,
+// check FENs from users with is_valid_fen first: syntax, one king per side,
+// no pawns on the back ranks, castling rights backed by king and rook on
+// their home squares, en passant square behind a just-pushed enemy pawn.
+bool is_valid_fen(const std::string& fen);
 void parse_fen(char* fen, Board& board);
 std::string board_to_fen(const Board& board);
 
+#include "movegen_impl.h"
+
 #endif
@@ -0,0 +1,336 @@
+#ifndef MOVEGEN_IMPL_H
+#define MOVEGEN_IMPL_H
+
+// Move generator core, included at the end of movegen.h.
+// Every generator takes a visitor called once per move; a visitor returning
+// false stops generation, and the false is passed up to the caller.
+
+// Count-only visitor: instead of being called per move it receives whole
+// target sets from the generator and popcounts them
+struct MoveCounter {
+    int count = 0;
+    bool operator()(Move) { count++; return true; }
+};
+
+// Serialize the targets of one piece (a set of moves from source)
+template <typename Visitor>
+inline bool visit_piece_targets(Visitor& visit, int source, U64 targets) {
+    while (targets) {
+        int target_square = __builtin_ctzll(targets);
+        if (!visit(new_move(source, target_square, QUIET))) return false;
+        pop_bit(targets, target_square);
+    }
+    return true;
+}
+
+inline bool visit_piece_targets(MoveCounter& counter, int, U64 targets) {
+    counter.count += __builtin_popcountll(targets);
+    return true;
+}
+
+// Side-relative constants (white moves up the board, towards lower indices)
+template <int Side> constexpr int pawn_push = (Side == 0) ? -8 : 8;
+constexpr int pawn_push_of(int side) { return (side == 0) ? -8 : 8; }
+template <int Side> constexpr U64 last_rank = (Side == 0) ? 0x00000000000000ffULL : 0xff00000000000000ULL; // Rank 8 / Rank 1
+template <int Side> constexpr U64 third_rank = (Side == 0) ? 0x0000ff0000000000ULL : 0x0000000000ff0000ULL; // Rank 3 / Rank 6
+template <int Side> constexpr int back_rank = (Side == 0) ? 0 : -56; // Offset from a rank 1 square to its rank 8 twin
+
+// Visit a pawn move, expanding it into the four promotions on the last rank
+template <typename Visitor>
+inline bool visit_pawn_move(Visitor& visit, int source, int target, int flag, int promotion) {
+    if (promotion) {
+        return visit(new_move(source, target, PROMOTION_Q)) &&
+               visit(new_move(source, target, PROMOTION_R)) &&
+               visit(new_move(source, target, PROMOTION_B)) &&
+               visit(new_move(source, target, PROMOTION_N));
+    }
+    return visit(new_move(source, target, flag));
+}
+
+// Shift a bitboard by a signed square delta
+template <int Delta>
+inline U64 shift(U64 bitboard) {
+    return (Delta > 0) ? (bitboard << Delta) : (bitboard >> -Delta);
+}
+
+// Pawns that may move by delta: all unpinned pawns, plus pinned pawns whose
+// destination stays on the line through their king
+template <int Delta>
+inline U64 pawns_free_to_move(U64 pawns, U64 pinned, int king_sq) {
+    U64 movable = pawns & ~pinned;
+    U64 pinned_pawns = pawns & pinned;
+    
+    while (pinned_pawns) {
+        int source_square = __builtin_ctzll(pinned_pawns);
+        // Shifting the bitboard drops destinations off the board edge
+        if (shift<Delta>(1ULL << source_square) & line[king_sq][source_square]) set_bit(movable, source_square);
+        pop_bit(pinned_pawns, source_square);
+    }
+    
+    return movable;
+}
+
+// Serialize pawn target squares, each reached from target - delta
+template <typename Visitor>
+inline bool visit_pawn_targets(Visitor& visit, U64 targets, int delta, int flag, int promotion) {
+    while (targets) {
+        int target_square = __builtin_ctzll(targets);
+        if (!visit_pawn_move(visit, target_square - delta, target_square, flag, promotion)) return false;
+        pop_bit(targets, target_square);
+    }
+    return true;
+}
+
+// Each promotion target stands for four moves
+inline bool visit_pawn_targets(MoveCounter& counter, U64 targets, int, int, int promotion) {
+    counter.count += __builtin_popcountll(targets) * (promotion ? 4 : 1);
+    return true;
+}
+
+// Pawn moves, generated for all pawns at once with whole-bitboard shifts.
+// target limits destination squares (evasions), pinned pawns stay on the
+// line through their king. Legal also checks en passant for discovered
+// attacks on the king. CAPTURES yields captures and all promotions, QUIETS
+// the remaining pushes, QUIET_CHECKS the pushes that give check.
+template <int Side, int Legal, int Type, typename Visitor>
+inline bool generate_pawn_moves(const Board& board, Visitor& visit, U64 target, U64 pinned, int king_sq, U64 check,
+                                const CheckInfo& checks) {
+    constexpr int quiet = (Type == GEN_QUIETS || Type == GEN_QUIET_CHECKS);
+    constexpr int piece = (Side == 0) ? P : p;
+    constexpr int push = pawn_push<Side>;
+    constexpr int left = push - 1;  // Capture towards the a-file
+    constexpr int right = push + 1; // Capture towards the h-file
+    constexpr U64 promo = last_rank<Side>;
+    U64 empty = ~board.occupancies[2];
+    U64 enemy = board.occupancies[Side ^ 1];
+    U64 pawns = board.bitboards[piece];
+    
+    // 1. Single Push, 2. Double Push
+    U64 single = shift<push>(pawns_free_to_move<push>(pawns, pinned, king_sq)) & empty;
+    U64 double_push = shift<push>(single & third_rank<Side>) & empty & target;
+    single &= target;
+    if constexpr (Type == GEN_QUIET_CHECKS) {
+        // Direct checks, or a push off the line of a discovered check
+        // (a push always leaves the line unless it runs along the file)
+        U64 direct = checks.check_squares[P];
+        U64 discovered = shift<push>(pawns & checks.discoverers & ~(0x0101010101010101ULL << (checks.king_square & 7)));
+        single &= direct | discovered;
+        double_push &= direct | shift<push>(discovered);
+    }
+    if (!quiet && !visit_pawn_targets(visit, single & promo, push, QUIET, 1)) return false;
+    if (Type != GEN_CAPTURES) {
+        if (!visit_pawn_targets(visit, single & ~promo, push, QUIET, 0)) return false;
+        if (!visit_pawn_targets(visit, double_push, push + push, DOUBLE_PUSH, 0)) return false;
+    }
+    if (quiet) return true;
+    
+    // 3. Captures (file masks drop shifts that wrapped around the board edge)
+    U64 left_captures = shift<left>(pawns_free_to_move<left>(pawns, pinned, king_sq)) & not_h_file & enemy & target;
+    U64 right_captures = shift<right>(pawns_free_to_move<right>(pawns, pinned, king_sq)) & not_a_file & enemy & target;
+    if (!visit_pawn_targets(visit, left_captures & ~promo, left, QUIET, 0)) return false;
+    if (!visit_pawn_targets(visit, left_captures & promo, left, QUIET, 1)) return false;
+    if (!visit_pawn_targets(visit, right_captures & ~promo, right, QUIET, 0)) return false;
+    if (!visit_pawn_targets(visit, right_captures & promo, right, QUIET, 1)) return false;
+    
+    // 4. En Passant
+    if (board.enpassant != no_sq) {
+        int captured = board.enpassant - push;
+        
+        // In check it must block (ep square) or remove the checking pawn
+        if (!get_bit(target, board.enpassant) && !get_bit(check, captured)) return true;
+        
+        // Our pawns attacking the ep square (reverse pawn attack lookup)
+        U64 attackers = pawn_attacks[Side ^ 1][board.enpassant] & pawns;
+        while (attackers) {
+            int source_square = __builtin_ctzll(attackers);
+            int safe = 1;
+            if (Legal) {
+                // Both pawns leave their squares at once, so test the king for
+                // sliders on the resulting occupancy. This covers ordinary pins
+                // and the horizontal case where the two pawns shield the king.
+                U64 after = board.occupancies[2] ^ (1ULL << source_square) ^ (1ULL << captured) ^ (1ULL << board.enpassant);
+                U64 rook_queen = (Side == 0) ? (board.bitboards[r] | board.bitboards[q]) : (board.bitboards[R] | board.bitboards[Q]);
+                U64 bishop_queen = (Side == 0) ? (board.bitboards[b] | board.bitboards[q]) : (board.bitboards[B] | board.bitboards[Q]);
+                safe = !(get_rook_attacks(king_sq, after) & rook_queen) &&
+                       !(get_bishop_attacks(king_sq, after) & bishop_queen);
+            }
+            if (safe && !visit(new_move(source_square, board.enpassant, EN_PASSANT))) return false;
+            pop_bit(attackers, source_square);
+        }
+    }
+    return true;
+}
+
+// Attacks of a non-pawn piece type (white piece index)
+template <int Piece>
+inline U64 piece_attacks(int square, U64 occupancy) {
+    if constexpr (Piece == N) return knight_attacks[square];
+    else if constexpr (Piece == B) return get_bishop_attacks(square, occupancy);
+    else if constexpr (Piece == R) return get_rook_attacks(square, occupancy);
+    else if constexpr (Piece == Q) return get_queen_attacks(square, occupancy);
+    else return king_attacks[square];
+}
+
+// Knight, bishop, rook, queen or king moves of the side to move.
+// QUIET_CHECKS keeps moves that attack the enemy king or uncover an attack.
+template <int Side, int Piece, int Type, typename Visitor>
+inline bool generate_piece_moves(const Board& board, Visitor& visit, U64 target, U64 pinned, int king_sq,
+                                 const CheckInfo& checks) {
+    constexpr int piece = (Side == 0) ? Piece : Piece + p;
+    U64 bitboard = board.bitboards[piece];
+    
+    while (bitboard) {
+        int source_square = __builtin_ctzll(bitboard);
+        U64 attacks = piece_attacks<Piece>(source_square, board.occupancies[2]) & target;
+        
+        // A pinned piece may only move along the line through its king
+        // (pinned knights end up with no moves: no knight move stays on a line)
+        if (get_bit(pinned, source_square)) attacks &= line[king_sq][source_square];
+        
+        if constexpr (Type == GEN_QUIET_CHECKS) {
+            U64 checking = checks.check_squares[Piece];
+            if (get_bit(checks.discoverers, source_square)) checking |= ~line[checks.king_square][source_square];
+            attacks &= checking;
+        }
+        
+        if (!visit_piece_targets(visit, source_square, attacks)) return false;
+        
+        pop_bit(bitboard, source_square);
+    }
+    return true;
+}
+
+// Castling moves for the side to move.
+// The king may not start on, pass over or land on an attacked square,
+// so one attack map of the opponent answers all three squares with an AND.
+// QUIET_CHECKS keeps castling only when the rook lands with check.
+template <int Side, int Type, typename Visitor>
+inline bool generate_castling(const Board& board, Visitor& visit, U64 attacked) {
+    constexpr int offset = back_rank<Side>;
+    constexpr int king_side = (Side == 0) ? 1 : 4;
+    constexpr int queen_side = (Side == 0) ? 2 : 8;
+    // King side (e1 -> g1): f1, g1 empty; e1, f1, g1 not attacked
+    constexpr U64 king_side_empty = (1ULL << (f1 + offset)) | (1ULL << (g1 + offset));
+    constexpr U64 king_side_safe = (1ULL << (e1 + offset)) | king_side_empty;
+    // Queen side (e1 -> c1): d1, c1, b1 empty; e1, d1, c1 not attacked
+    // (b1 is irrelevant to the King path, only the rook moves over it)
+    constexpr U64 queen_side_safe = (1ULL << (e1 + offset)) | (1ULL << (d1 + offset)) | (1ULL << (c1 + offset));
+    constexpr U64 queen_side_empty = (1ULL << (d1 + offset)) | (1ULL << (c1 + offset)) | (1ULL << (b1 + offset));
+    
+    int king_side_ok = 1, queen_side_ok = 1;
+    if (Type == GEN_QUIET_CHECKS) {
+        U64 enemy_king = board.bitboards[(Side == 0) ? k : K];
+        U64 king_from = 1ULL << (e1 + offset);
+        U64 king_side_after = board.occupancies[2] ^ king_from ^ (1ULL << (g1 + offset)) ^ (1ULL << (h1 + offset)) ^ (1ULL << (f1 + offset));
+        U64 queen_side_after = board.occupancies[2] ^ king_from ^ (1ULL << (c1 + offset)) ^ (1ULL << (a1 + offset)) ^ (1ULL << (d1 + offset));
+        king_side_ok = (get_rook_attacks(f1 + offset, king_side_after) & enemy_king) != 0;
+        queen_side_ok = (get_rook_attacks(d1 + offset, queen_side_after) & enemy_king) != 0;
+    }
+    
+    if (king_side_ok && (board.castle & king_side) && !(board.occupancies[2] & king_side_empty) && !(attacked & king_side_safe)) {
+        if (!visit(new_move(e1 + offset, g1 + offset, KING_CASTLE))) return false;
+    }
+    if (queen_side_ok && (board.castle & queen_side) && !(board.occupancies[2] & queen_side_empty) && !(attacked & queen_side_safe)) {
+        if (!visit(new_move(e1 + offset, c1 + offset, QUEEN_CASTLE))) return false;
+    }
+    return true;
+}
+
+// Pseudo-legal moves for one side
+template <int Side, typename Visitor>
+bool generate_pseudo_legal(const Board& board, Visitor& visit) {
+    U64 target = ~board.occupancies[Side];
+    CheckInfo checks{}; // Only read by GEN_QUIET_CHECKS
+    
+    if (!generate_pawn_moves<Side, 0, GEN_ALL>(board, visit, target, 0ULL, 0, 0ULL, checks)) return false;
+    if (!generate_piece_moves<Side, N, GEN_ALL>(board, visit, target, 0ULL, 0, checks)) return false;
+    if (!generate_piece_moves<Side, B, GEN_ALL>(board, visit, target, 0ULL, 0, checks)) return false;
+    if (!generate_piece_moves<Side, R, GEN_ALL>(board, visit, target, 0ULL, 0, checks)) return false;
+    if (!generate_piece_moves<Side, Q, GEN_ALL>(board, visit, target, 0ULL, 0, checks)) return false;
+    if (!generate_piece_moves<Side, K, GEN_ALL>(board, visit, target, 0ULL, 0, checks)) return false;
+    
+    if (board.castle & ((Side == 0) ? 3 : 12)) {
+        return generate_castling<Side, GEN_ALL>(board, visit, attacked_squares(Side ^ 1, board.bitboards, board.occupancies[2]));
+    }
+    return true;
+}
+
+// Legal moves for one side, restricted to one generation mode.
+// Check and pin masks are computed once up front, so no move needs a
+// make_move + king attack test to be validated.
+template <int Side, int Type, typename Visitor>
+bool generate_legal(const Board& board, Visitor& visit) {
+    U64 king = board.bitboards[(Side == 0) ? K : k];
+    
+    // Setups without a king have nothing to keep safe: every pseudo-legal
+    // move is legal, filtered down to the mode (never in check, so no evasions)
+    if (!king) {
+        if constexpr (Type == GEN_ALL) return generate_pseudo_legal<Side>(board, visit);
+        if constexpr (Type == GEN_EVASIONS) return true;
+        CheckInfo checks{};
+        if constexpr (Type == GEN_QUIET_CHECKS) init_check_info(board, checks);
+        auto in_mode = [&board, &visit, &checks](Move move) {
+            bool noisy = is_capture(board, move) || move_is_promotion(move);
+            if (Type == GEN_CAPTURES ? !noisy : noisy) return true;
+            if (Type == GEN_QUIET_CHECKS && !gives_check(board, move, checks)) return true;
+            return visit(move);
+        };
+        return generate_pseudo_legal<Side>(board, in_mode);
+    }
+    
+    int king_sq = __builtin_ctzll(king);
+    U64 own = board.occupancies[Side];
+    U64 check = checkers(board);
+    
+    // Evasions only exist in check
+    if (Type == GEN_EVASIONS && !check) return true;
+    
+    U64 pinned = pinned_pieces(board, Side);
+    
+    // Checking moves need the check squares and the pieces that can discover
+    CheckInfo checks{};
+    if constexpr (Type == GEN_QUIET_CHECKS) {
+        init_check_info(board, checks);
+        if (checks.king_square == no_sq) return true;
+    }
+    
+    // Destination squares of this mode (pawns sort out promotions themselves)
+    U64 mode = (Type == GEN_CAPTURES) ? board.occupancies[Side ^ 1]
+             : (Type == GEN_QUIETS || Type == GEN_QUIET_CHECKS) ? ~board.occupancies[2] : ~own;
+    
+    // 1. King moves. Squares are tested with the king lifted off the board,
+    //    so it cannot step back along the ray of a checking slider.
+    U64 danger = attacked_squares(Side ^ 1, board.bitboards, board.occupancies[2] ^ king);
+    if (!generate_piece_moves<Side, K, Type>(board, visit, mode & ~own & ~danger, 0ULL, king_sq, checks)) return false;
+    
+    // Double check: only the king can move
+    if (check & (check - 1)) return true;
+    
+    // 2. Evasion mask: in check, other pieces must capture the checker or block
+    U64 target = ~own;
+    if (check) target &= check | between[king_sq][__builtin_ctzll(check)];
+    
+    if (!generate_pawn_moves<Side, 1, Type>(board, visit, target, pinned, king_sq, check, checks)) return false;
+    target &= mode;
+    if (!generate_piece_moves<Side, N, Type>(board, visit, target, pinned, king_sq, checks)) return false;
+    if (!generate_piece_moves<Side, B, Type>(board, visit, target, pinned, king_sq, checks)) return false;
+    if (!generate_piece_moves<Side, R, Type>(board, visit, target, pinned, king_sq, checks)) return false;
+    if (!generate_piece_moves<Side, Q, Type>(board, visit, target, pinned, king_sq, checks)) return false;
+    
+    // 3. Castling (never out of check; danger already covers the king path)
+    if (Type != GEN_CAPTURES && !check && (board.castle & ((Side == 0) ? 3 : 12))) return generate_castling<Side, Type>(board, visit, danger);
+    return true;
+}
+
+// Visitor entry points (declared in movegen.h)
+template <typename Visitor>
+bool generate_moves(const Board& board, Visitor&& visit) {
+    return (board.side == 0) ? generate_pseudo_legal<0>(board, visit) : generate_pseudo_legal<1>(board, visit);
+}
+
+template <int Type, typename Visitor>
+bool generate(const Board& board, Visitor&& visit) {
+    return (board.side == 0) ? generate_legal<0, Type>(board, visit) : generate_legal<1, Type>(board, visit);
+}
+
+#endif
@@ -0,0 +1,122 @@
+#include "movepick.h"
+#include "see.h"
+
+// A move that did not come from the generator (hash move, killer) must be
+// checked against the position before it is handed out
+static int is_valid_move(const Board& board, Move move) {
+    return move && is_pseudo_legal(board, move) && is_legal(board, move);
+}
+
+// Captured piece type of a capture (P..K), -1 for a quiet promotion
+static int victim_type(const Board& board, Move move) {
+    if (move_is_enpassant(move)) return P;
+
+    int victim = piece_on(board, move_target(move));
+    return (victim == no_piece) ? -1 : victim % 6;
+}
+
+// Score captures by MVV-LVA (most valuable victim, then least valuable
+// attacker), promotions by the value they add. Values are SEE's, so the
+// ordering and the good/bad split agree on what a piece is worth.
+static void score_captures(MovePicker& picker) {
+    const Board& board = *picker.board;
+
+    for (int i = 0; i < picker.captures.count; i++) {
+        Move move = picker.captures.moves[i];
+        int victim = victim_type(board, move);
+        int value = (victim >= 0 ? see_value[victim] : 0) + (move_is_promotion(move) ? see_value[move_promoted_type(move)] : 0);
+        picker.scores[i] = value * 8 - piece_on(board, move_source(move)) % 6;
+    }
+}
+
+// A capture that loses material once the exchange on its target square is
+// played out. Promotions are always tried with the good captures.
+static int is_bad_capture(const Board& board, Move move) {
+    if (move_is_promotion(move)) return 0;
+    return !see_ge(board, move, 0);
+}
+
+void init_move_picker(MovePicker& picker, const Board& board, Move hash_move, Move killer1, Move killer2) {
+    picker.board = &board;
+    picker.stage = STAGE_HASH;
+    picker.hash_move = is_valid_move(board, hash_move) ? hash_move : 0;
+    picker.killers[0] = killer1;
+    picker.killers[1] = (killer2 != killer1) ? killer2 : 0;
+    picker.killer_index = 0;
+    picker.capture_index = 0;
+    picker.bad_count = 0;
+    picker.bad_index = 0;
+    picker.quiet_index = 0;
+}
+
+Move next_move(MovePicker& picker) {
+    const Board& board = *picker.board;
+
+    switch (picker.stage) {
+        case STAGE_HASH:
+            picker.stage++;
+            if (picker.hash_move) return picker.hash_move;
+            // fall through
+
+        case STAGE_GEN_CAPTURES:
+            generate<GEN_CAPTURES>(board, picker.captures);
+            score_captures(picker);
+            picker.stage++;
+            // fall through
+
+        case STAGE_GOOD_CAPTURES:
+            while (picker.capture_index < picker.captures.count) {
+                // Selection sort one step at a time: most moves are never reached
+                int best = picker.capture_index;
+                for (int i = best + 1; i < picker.captures.count; i++) {
+                    if (picker.scores[i] > picker.scores[best]) best = i;
+                }
+                Move move = picker.captures.moves[best];
+                picker.captures.moves[best] = picker.captures.moves[picker.capture_index];
+                picker.scores[best] = picker.scores[picker.capture_index];
+                picker.capture_index++;
+
+                if (move == picker.hash_move) continue;
+                if (is_bad_capture(board, move)) {
+                    picker.bad_captures[picker.bad_count++] = move;
+                    continue;
+                }
+                return move;
+            }
+            picker.stage++;
+            // fall through
+
+        case STAGE_KILLERS:
+            while (picker.killer_index < 2) {
+                Move move = picker.killers[picker.killer_index++];
+                // Killers are quiet moves; captures were already handed out
+                if (!move || move == picker.hash_move) continue;
+                if (is_capture(board, move) || move_is_promotion(move)) continue;
+                if (is_valid_move(board, move)) return move;
+            }
+            picker.stage++;
+            // fall through
+
+        case STAGE_GEN_QUIETS:
+            generate<GEN_QUIETS>(board, picker.quiets);
+            picker.stage++;
+            // fall through
+
+        case STAGE_QUIETS:
+            while (picker.quiet_index < picker.quiets.count) {
+                Move move = picker.quiets.moves[picker.quiet_index++];
+                if (move == picker.hash_move || move == picker.killers[0] || move == picker.killers[1]) continue;
+                return move;
+            }
+            picker.stage++;
+            // fall through
+
+        case STAGE_BAD_CAPTURES:
+            if (picker.bad_index < picker.bad_count) return picker.bad_captures[picker.bad_index++];
+            picker.stage++;
+            // fall through
+
+        default:
+            return 0;
+    }
+}
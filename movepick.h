@@ -0,0 +1,43 @@
+#ifndef MOVEPICK_H
+#define MOVEPICK_H
+
+#include "movegen.h"
+
+// Move picker stages, in the order moves are handed out
+enum {
+    STAGE_HASH,
+    STAGE_GEN_CAPTURES, STAGE_GOOD_CAPTURES,
+    STAGE_KILLERS,
+    STAGE_GEN_QUIETS, STAGE_QUIETS,
+    STAGE_BAD_CAPTURES,
+    STAGE_DONE
+};
+
+// Staged move picker: hands out legal moves one at a time and only
+// generates a stage once the previous one has run out, so a search that
+// cuts off after the first few moves never pays for the rest.
+struct MovePicker {
+    const Board* board;
+    int stage;
+    Move hash_move;
+    Move killers[2];
+    int killer_index;
+
+    Moves captures;           // Generated captures and promotions
+    int scores[256];          // MVV-LVA score per capture
+    int capture_index;
+    Move bad_captures[256];   // Losing captures, deferred to the last stage
+    int bad_count;
+    int bad_index;
+
+    Moves quiets;
+    int quiet_index;
+};
+
+// Start picking moves for a position. hash_move and killers may be 0 (none);
+// they are checked against the position before being returned.
+void init_move_picker(MovePicker& picker, const Board& board, Move hash_move, Move killer1, Move killer2);
+// Next legal move, or 0 when all stages are exhausted
+Move next_move(MovePicker& picker);
+
+#endif
@@ -1,88 +1,387 @@
 #include <iostream>
+#include <algorithm>
 #include <chrono>
-#include "movegen.h"
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include "perft.h"
 
-// Leaf node count
-long long nodes = 0;
-
-// Perft recursive function
-void perft(Board board, int depth) {
-    if (depth == 0) {
-        nodes++;
-        return;
-    }
+// Perft recursive function, returns the leaf count
+long long perft(const Board& board, int depth) {
+    if (depth == 0) return 1;
+    
+    // Last ply: count the leaves without generating or making them
+    if (depth == 1) return count_legal_moves(board);
     
     Moves moves;
-    generate_moves(board, moves);
+    generate_legal_moves(board, moves);
     
-    // Simple loop over moves
+    // Simple loop over moves (all legal, no king safety test needed)
+    long long nodes = 0;
     for (int i = 0; i < moves.count; i++) {
         // Copy board state
         Board next_board = board;
         
         // Execute move
-        if (!make_move(next_board, moves.moves[i], get_move_capture(moves.moves[i]))) {
-            continue; // Illegal move
-        }
+        make_legal_move(next_board, moves.moves[i]);
         
         // Recurse
-        perft(next_board, depth - 1);
+        nodes += perft(next_board, depth - 1);
     }
+    return nodes;
 }
 
-// Perft driver
-void perft_test(char* fen, int depth) {
-    Board board;
-    parse_fen(fen, board);
-    print_bitboard(board.occupancies[2]);
+// Perft recursive function, make/unmake on a single board (no copies)
+long long perft_unmake(Board& board, int depth) {
+    if (depth == 0) return 1;
     
-    nodes = 0;
+    if (depth == 1) return count_legal_moves(board);
     
-    std::cout << "\nStarting Perft Test for Depth " << depth << "\n";
-    auto start = std::chrono::high_resolution_clock::now();
+    Moves moves;
+    generate_legal_moves(board, moves);
+    
+    long long nodes = 0;
+    for (int i = 0; i < moves.count; i++) {
+        Undo undo;
+        make_legal_move(board, moves.moves[i], undo);
+        nodes += perft_unmake(board, depth - 1);
+        unmake_move(board, moves.moves[i], undo);
+    }
+    return nodes;
+}
+
+// Allocate the largest power of two bucket count that fits in 'megabytes'
+void init_perft_table(PerftTable& table, int megabytes) {
+    U64 count = 1;
+    while (count * 2 * sizeof(PerftBucket) <= (U64)megabytes * 1024 * 1024) count *= 2;
+    table.buckets = std::vector<PerftBucket>(count);
+    table.mask = count - 1;
+}
+
+static bool probe_perft_table(const PerftTable& table, U64 hash, int depth, long long& nodes) {
+    const PerftBucket& bucket = table.buckets[hash & table.mask];
+    for (const PerftEntry& entry : bucket.entries) {
+        U64 data = entry.data.load(std::memory_order_relaxed);
+        U64 key = entry.key.load(std::memory_order_relaxed);
+        if ((key ^ data) == hash && (int)(data & 0xff) == depth) {
+            nodes = (long long)(data >> 8);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Replaces the entry of the same position and depth if there is one, else
+// the shallowest entry (the cheapest subtree to count again)
+static void store_perft_table(PerftTable& table, U64 hash, int depth, long long nodes) {
+    PerftBucket& bucket = table.buckets[hash & table.mask];
+    PerftEntry* replace = &bucket.entries[0];
+    for (PerftEntry& entry : bucket.entries) {
+        U64 data = entry.data.load(std::memory_order_relaxed);
+        if ((entry.key.load(std::memory_order_relaxed) ^ data) == hash && (int)(data & 0xff) == depth) {
+            replace = &entry;
+            break;
+        }
+        if ((data & 0xff) < (replace->data.load(std::memory_order_relaxed) & 0xff)) replace = &entry;
+    }
+    
+    U64 data = ((U64)nodes << 8) | (U64)depth;
+    replace->key.store(hash ^ data, std::memory_order_relaxed);
+    replace->data.store(data, std::memory_order_relaxed);
+}
+
+// Perft with subtree counts cached by position and depth (the last ply is
+// bulk counted, so only depth 2 and up goes through the table)
+long long perft_hashed(const Board& board, int depth, PerftTable& table, PerftStats& stats) {
+    if (depth <= 1) return perft(board, depth);
+    
+    long long nodes = 0;
+    stats.probes++;
+    if (probe_perft_table(table, board.hash, depth, nodes)) {
+        stats.hits++;
+        return nodes;
+    }
     
-    // Root moves
     Moves moves;
-    generate_moves(board, moves);
+    generate_legal_moves(board, moves);
+    for (int i = 0; i < moves.count; i++) {
+        Board next_board = board;
+        make_legal_move(next_board, moves.moves[i]);
+        nodes += perft_hashed(next_board, depth - 1, table, stats);
+    }
+    
+    store_perft_table(table, board.hash, depth, nodes);
+    return nodes;
+}
+
+// A subtree below root move 'root', counted by whichever worker takes it
+struct PerftTask {
+    Board board;
+    int depth;
+    int root;
+};
+
+// One queue per worker: the owner takes tasks from the back, idle workers
+// steal from the front
+struct TaskQueue {
+    std::mutex lock;
+    std::deque<PerftTask> tasks;
+};
+
+// Expand 'plies' levels below a root move and deal the positions out to
+// the worker queues in turn
+static void split_tasks(const Board& board, int depth, int plies, int root, std::vector<TaskQueue>& queues, int& next_queue) {
+    if (plies == 0 || depth <= 1) {
+        queues[next_queue].tasks.push_back({ board, depth, root });
+        next_queue = (next_queue + 1) % (int)queues.size();
+        return;
+    }
     
+    Moves moves;
+    generate_legal_moves(board, moves);
     for (int i = 0; i < moves.count; i++) {
         Board next_board = board;
-        if (!make_move(next_board, moves.moves[i], get_move_capture(moves.moves[i]))) {
-            continue;
+        make_legal_move(next_board, moves.moves[i]);
+        split_tasks(next_board, depth - 1, plies - 1, root, queues, next_queue);
+    }
+}
+
+// Next task for worker 'self': its own newest task, else the oldest task
+// of another worker. All tasks exist before the workers start, so empty
+// queues everywhere means the work is done.
+static bool take_task(std::vector<TaskQueue>& queues, int self, PerftTask& task) {
+    int count = (int)queues.size();
+    for (int i = 0; i < count; i++) {
+        TaskQueue& queue = queues[(self + i) % count];
+        std::lock_guard<std::mutex> guard(queue.lock);
+        if (queue.tasks.empty()) continue;
+        if (i == 0) {
+            task = queue.tasks.back();
+            queue.tasks.pop_back();
+        } else {
+            task = queue.tasks.front();
+            queue.tasks.pop_front();
         }
-        
-        long long old_nodes = nodes;
-        perft(next_board, depth - 1);
-        long long new_nodes = nodes - old_nodes;
-        
-        std::cout << "move: ";
-        print_move(moves.moves[i]);
-        std::cout << " nodes: " << new_nodes << "\n";
+        return true;
+    }
+    return false;
+}
+
+// Node count below each root move, split 'split' plies deep into tasks
+// shared by 'threads' workers (and their hash table, if any)
+std::vector<long long> perft_parallel(const Board& board, const Moves& root_moves, int depth, int threads, int split,
+                                      PerftTable* table, PerftStats& stats) {
+    std::vector<TaskQueue> queues(threads);
+    int next_queue = 0;
+    for (int i = 0; i < root_moves.count; i++) {
+        Board next_board = board;
+        make_legal_move(next_board, root_moves.moves[i]);
+        split_tasks(next_board, depth - 1, split - 1, i, queues, next_queue);
     }
     
-    auto end = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double> explained = end - start;
+    // Each worker counts into its own array, summed once all have finished
+    std::vector<std::vector<long long>> counts(threads, std::vector<long long>(root_moves.count, 0));
+    std::vector<PerftStats> thread_stats(threads);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&queues, &counts, &thread_stats, table, t]() {
+            PerftTask task;
+            while (take_task(queues, t, task)) {
+                counts[t][task.root] += table ? perft_hashed(task.board, task.depth, *table, thread_stats[t])
+                                              : perft(task.board, task.depth);
+            }
+        });
+    }
+    for (std::thread& worker : workers) worker.join();
+    
+    std::vector<long long> nodes(root_moves.count, 0);
+    for (int t = 0; t < threads; t++) {
+        for (int i = 0; i < root_moves.count; i++) nodes[i] += counts[t][i];
+        stats.probes += thread_stats[t].probes;
+        stats.hits += thread_stats[t].hits;
+    }
+    return nodes;
+}
+
+// Time copy-make against make/unmake on the same position
+void perft_benchmark(const Board& position, int depth) {
+    Board board = position;
+    
+    for (int mode = 0; mode < 2; mode++) {
+        auto start = std::chrono::high_resolution_clock::now();
+        long long nodes = (mode == 0) ? perft(board, depth) : perft_unmake(board, depth);
+        auto end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> elapsed = end - start;
+        
+        std::cout << (mode == 0 ? "Copy-make:   " : "Make/unmake: ") << nodes << " nodes, "
+                  << elapsed.count() * 1000 << " ms, NPS: " << (nodes / elapsed.count()) << "\n";
+    }
+}
+
+// Node count below each root move. With more than one thread the subtrees
+// are counted in parallel; the counts are the same either way. table may
+// be null (no hashing).
+std::vector<long long> perft_divide(const Board& board, const Moves& moves, int depth, int threads, int split,
+                                    PerftTable* table, PerftStats& stats) {
+    if (threads > 1) return perft_parallel(board, moves, depth, threads, split, table, stats);
     
-    std::cout << "\nTotal nodes: " << nodes;
-    std::cout << "\nTime: " << explained.count() * 1000 << " ms\n";
-    std::cout << "NPS: " << (nodes / explained.count()) << "\n";
+    std::vector<long long> divide(moves.count, 0);
+    for (int i = 0; i < moves.count; i++) {
+        Board next_board = board;
+        make_legal_move(next_board, moves.moves[i]);
+        divide[i] = table ? perft_hashed(next_board, depth - 1, *table, stats) : perft(next_board, depth - 1);
+    }
+    return divide;
+}
+
+#ifndef PERFT_LIB
+// Command line settings
+struct PerftOptions {
+    std::string fen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+    std::vector<std::string> moves; // UCI moves played before counting
+    int depth = 0;
+    bool divide = false;
+    int threads = 1;
+    int split = 2;
+    int hash_mb = 0;
+    bool json = false;
+    bool bench = false;
+};
+
+static void print_usage() {
+    std::cerr << "Usage: perft [--fen FEN] [--moves MOVE...] --depth N [options]\n"
+                 "  --fen FEN       Position to count (default: start position)\n"
+                 "  --moves MOVE... UCI moves to play first, e.g. --moves e2e4 e7e5\n"
+                 "  --depth N       Perft depth (1 or more)\n"
+                 "  --divide        Node count per root move\n"
+                 "  --threads N     Worker threads (default 1)\n"
+                 "  --split D       Plies expanded into tasks with --threads (default 2)\n"
+                 "  --hash MB       Perft hash table size (default 0, no table)\n"
+                 "  --json          Machine-readable output\n"
+                 "  --bench         Time copy-make against make/unmake instead\n";
+}
+
+// Parse the command line. FEN fields and moves may be given as separate
+// arguments, they run up to the next option.
+static bool parse_options(int argc, char* argv[], PerftOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        
+        if (arg == "--fen" && has_value) {
+            options.fen = argv[++i];
+            while (i + 1 < argc && strncmp(argv[i + 1], "--", 2)) options.fen += std::string(" ") + argv[++i];
+        } else if (arg == "--moves") {
+            while (i + 1 < argc && strncmp(argv[i + 1], "--", 2)) options.moves.push_back(argv[++i]);
+        } else if (arg == "--depth" && has_value) {
+            options.depth = atoi(argv[++i]);
+        } else if (arg == "--threads" && has_value) {
+            options.threads = std::max(1, atoi(argv[++i]));
+        } else if (arg == "--split" && has_value) {
+            options.split = std::max(1, atoi(argv[++i]));
+        } else if (arg == "--hash" && has_value) {
+            options.hash_mb = std::max(0, atoi(argv[++i]));
+        } else if (arg == "--divide") {
+            options.divide = true;
+        } else if (arg == "--json") {
+            options.json = true;
+        } else if (arg == "--bench") {
+            options.bench = true;
+        } else {
+            std::cerr << "Unknown or incomplete option: " << arg << "\n";
+            return false;
+        }
+    }
+    return options.depth >= 1;
 }
 
-int main() {
-    init_leapers_attacks();
+int main(int argc, char* argv[]) {
+    PerftOptions options;
+    if (!parse_options(argc, argv, options)) {
+        print_usage();
+        return 1;
+    }
+    
+    if (!is_valid_fen(options.fen)) {
+        std::cerr << "Invalid FEN: " << options.fen << "\n";
+        return 1;
+    }
+    Board board;
+    parse_fen(&options.fen[0], board);
+    for (const std::string& uci : options.moves) {
+        Move move = parse_uci_move(board, uci);
+        if (!move) {
+            std::cerr << "Illegal move: " << uci << "\n";
+            return 1;
+        }
+        make_legal_move(board, move);
+    }
+    
+    if (options.bench) {
+        perft_benchmark(board, options.depth);
+        return 0;
+    }
     
-    // Start Position
-    char* start_position = (char*)"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
-    // KiwiPete
-    char* kiwipete = (char*)"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1";
+    PerftTable table;
+    if (options.hash_mb) init_perft_table(table, options.hash_mb);
+    PerftTable* hash_table = options.hash_mb ? &table : nullptr;
     
-    std::cout << "-----------------------\n";
-    std::cout << "Position 1 (Start Pos)\n";
-    perft_test(start_position, 3); // Depth 3 (Should be 8902 nodes)
+    auto start = std::chrono::high_resolution_clock::now();
+    
+    Moves moves;
+    generate_legal_moves(board, moves);
+    PerftStats stats;
+    std::vector<long long> divide = perft_divide(board, moves, options.depth, options.threads, options.split, hash_table, stats);
+    long long nodes = 0;
+    for (long long count : divide) nodes += count;
     
-    std::cout << "\n-----------------------\n";
-    std::cout << "Position 2 (KiwiPete)\n";
-    perft_test(kiwipete, 1); // Depth 1 (Should be 48)
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed = end - start;
+    long long nps = elapsed.count() > 0 ? (long long)(nodes / elapsed.count()) : 0;
     
+    if (options.json) {
+        std::cout << "{\n";
+        std::cout << "  \"backend\": \"" << slider_backend_name() << "\",\n";
+        std::cout << "  \"fen\": \"" << board_to_fen(board) << "\",\n";
+        std::cout << "  \"depth\": " << options.depth << ",\n";
+        std::cout << "  \"threads\": " << options.threads << ",\n";
+        std::cout << "  \"nodes\": " << nodes << ",\n";
+        std::cout << "  \"time_ms\": " << elapsed.count() * 1000 << ",\n";
+        std::cout << "  \"nps\": " << nps;
+        if (hash_table) {
+            std::cout << ",\n  \"hash\": { \"probes\": " << stats.probes << ", \"hits\": " << stats.hits << " }";
+        }
+        if (options.divide) {
+            std::cout << ",\n  \"divide\": [";
+            for (int i = 0; i < moves.count; i++) {
+                std::cout << (i ? ",\n" : "\n") << "    { \"move\": \"" << move_to_uci(moves.moves[i]) << "\", \"nodes\": " << divide[i] << " }";
+            }
+            std::cout << (moves.count ? "\n  ]" : "]");
+        }
+        std::cout << "\n}\n";
+        return 0;
+    }
+    
+    std::cout << "Slider backend: " << slider_backend_name() << "\n";
+    std::cout << "Position: " << board_to_fen(board) << "\n";
+    std::cout << "Depth: " << options.depth << "\n\n";
+    if (options.divide) {
+        for (int i = 0; i < moves.count; i++) {
+            std::cout << "move: ";
+            print_move(moves.moves[i]);
+            std::cout << " nodes: " << divide[i] << "\n";
+        }
+        std::cout << "\n";
+    }
+    std::cout << "Total nodes: " << nodes;
+    std::cout << "\nTime: " << elapsed.count() * 1000 << " ms\n";
+    std::cout << "NPS: " << nps << "\n";
+    if (hash_table) {
+        std::cout << "Hash: " << stats.hits << " hits / " << stats.probes << " probes ("
+                  << (stats.probes ? 100.0 * stats.hits / stats.probes : 0.0) << "%)\n";
+    }
     return 0;
 }
+#endif
@@ -0,0 +1,53 @@
+#ifndef PERFT_H
+#define PERFT_H
+
+#include <atomic>
+#include <vector>
+#include "movegen.h"
+
+// Perft hash entry, 16 bytes: data holds the node count above the depth
+// (low 8 bits), key holds the Zobrist key XORed with data. Both words are
+// written without a lock; an entry torn by two threads writing at once
+// fails the XOR check and reads as a miss instead of a wrong count.
+struct PerftEntry {
+    std::atomic<U64> key;
+    std::atomic<U64> data;
+};
+
+// Four entries per bucket, one cache line
+struct alignas(64) PerftBucket {
+    PerftEntry entries[4];
+};
+
+struct PerftTable {
+    std::vector<PerftBucket> buckets;
+    U64 mask; // Bucket count - 1 (a power of two)
+};
+
+// Probe and hit counts of one thread
+struct PerftStats {
+    long long probes = 0;
+    long long hits = 0;
+};
+
+// Leaf count, copy-make and make/unmake
+long long perft(const Board& board, int depth);
+long long perft_unmake(Board& board, int depth);
+
+// Allocate the largest power of two bucket count that fits in 'megabytes'
+void init_perft_table(PerftTable& table, int megabytes);
+// Perft through a hash table that may be shared between threads
+long long perft_hashed(const Board& board, int depth, PerftTable& table, PerftStats& stats);
+
+// Node count below each root move, in the order of moves. With more than
+// one thread the tree is split 'split' plies deep into tasks for a
+// work-stealing pool. table may be null (no hashing).
+std::vector<long long> perft_parallel(const Board& board, const Moves& root_moves, int depth, int threads, int split,
+                                      PerftTable* table, PerftStats& stats);
+std::vector<long long> perft_divide(const Board& board, const Moves& moves, int depth, int threads, int split,
+                                    PerftTable* table, PerftStats& stats);
+
+// Time copy-make against make/unmake on the same position
+void perft_benchmark(const Board& position, int depth);
+
+#endif
@@ -0,0 +1,19 @@
+# Run perft --divide serially and with worker threads sharing a hash table,
+# and fail unless the per-move counts match line for line.
+# Usage: cmake -DPERFT=<perft executable> -P perft_compare.cmake
+set(FEN "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1")
+
+execute_process(COMMAND ${PERFT} --fen ${FEN} --depth 4 --divide
+                OUTPUT_VARIABLE serial RESULT_VARIABLE serial_result)
+execute_process(COMMAND ${PERFT} --fen ${FEN} --depth 4 --divide --threads 4 --hash 16
+                OUTPUT_VARIABLE threaded RESULT_VARIABLE threaded_result)
+if(NOT serial_result EQUAL 0 OR NOT threaded_result EQUAL 0)
+    message(FATAL_ERROR "perft failed:\n${serial}\n${threaded}")
+endif()
+
+string(REGEX MATCHALL "move: [a-h1-8nbrq]+ nodes: [0-9]+|Total nodes: [0-9]+" serial_counts "${serial}")
+string(REGEX MATCHALL "move: [a-h1-8nbrq]+ nodes: [0-9]+|Total nodes: [0-9]+" threaded_counts "${threaded}")
+if(NOT serial_counts OR NOT serial_counts STREQUAL threaded_counts)
+    message(FATAL_ERROR "Divide output differs:\n${serial}\n${threaded}")
+endif()
+message(STATUS "Serial and threaded divide match (${serial_counts})")
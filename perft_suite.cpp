@@ -0,0 +1,156 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include "perft.h"
+
+// One EPD line: position and expected node count per depth
+struct SuiteEntry {
+    std::string fen;
+    std::vector<std::pair<int, long long>> expected; // (depth, nodes)
+};
+
+// Outcome of one position, filled in by whichever thread ran it
+struct SuiteResult {
+    std::vector<long long> nodes; // Per checked depth
+    long long total = 0;
+    double seconds = 0;
+    bool passed = true;
+};
+
+// Parse "FEN ;D1 20 ;D2 400 ...". Blank lines and lines starting with '#'
+// are skipped.
+static bool parse_epd_line(const std::string& line, SuiteEntry& entry) {
+    if (line.empty() || line[0] == '#') return false;
+    
+    std::stringstream fields(line);
+    std::string field;
+    std::getline(fields, field, ';');
+    size_t last = field.find_last_not_of(" \t\r");
+    if (last == std::string::npos) return false;
+    entry.fen = field.substr(0, last + 1);
+    
+    entry.expected.clear();
+    while (std::getline(fields, field, ';')) {
+        int depth;
+        long long nodes;
+        if (sscanf(field.c_str(), " D%d %lld", &depth, &nodes) == 2) entry.expected.push_back({ depth, nodes });
+    }
+    return true;
+}
+
+// Check every depth of one position up to max_depth
+static void run_entry(const SuiteEntry& entry, int max_depth, PerftTable* table, SuiteResult& result) {
+    Board board;
+    std::string fen = entry.fen;
+    parse_fen(&fen[0], board);
+    PerftStats stats;
+    
+    auto start = std::chrono::high_resolution_clock::now();
+    for (const auto& expected : entry.expected) {
+        if (expected.first > max_depth) continue;
+        long long nodes = table ? perft_hashed(board, expected.first, *table, stats) : perft(board, expected.first);
+        result.nodes.push_back(nodes);
+        result.total += nodes;
+        if (nodes != expected.second) result.passed = false;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    result.seconds = std::chrono::duration<double>(end - start).count();
+}
+
+int main(int argc, char* argv[]) {
+    // perft_suite FILE [--depth N] [--threads N] [--hash MB]
+    const char* path = nullptr;
+    int max_depth = 6;
+    int threads = 1;
+    int hash_mb = 0;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--depth") && i + 1 < argc) max_depth = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--threads") && i + 1 < argc) threads = std::max(1, atoi(argv[++i]));
+        else if (!strcmp(argv[i], "--hash") && i + 1 < argc) hash_mb = std::max(0, atoi(argv[++i]));
+        else if (argv[i][0] != '-') path = argv[i];
+        else {
+            std::cerr << "Unknown or incomplete option: " << argv[i] << "\n";
+            path = nullptr;
+            break;
+        }
+    }
+    if (!path) {
+        std::cerr << "Usage: perft_suite FILE.epd [--depth N] [--threads N] [--hash MB]\n"
+                     "  --depth N    Skip depths above N (default 6)\n"
+                     "  --threads N  Positions run in parallel (default 1)\n"
+                     "  --hash MB    Perft hash table shared by all positions (default 0)\n";
+        return 1;
+    }
+    
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "Cannot open " << path << "\n";
+        return 1;
+    }
+    std::vector<SuiteEntry> entries;
+    std::string line;
+    SuiteEntry entry;
+    int line_number = 0;
+    while (std::getline(file, line)) {
+        line_number++;
+        if (!parse_epd_line(line, entry)) continue;
+        if (!is_valid_fen(entry.fen)) {
+            std::cerr << path << ":" << line_number << ": invalid FEN: " << entry.fen << "\n";
+            return 1;
+        }
+        entries.push_back(entry);
+    }
+    
+    PerftTable table;
+    if (hash_mb) init_perft_table(table, hash_mb);
+    PerftTable* hash_table = hash_mb ? &table : nullptr;
+    
+    // Workers take the next position in file order until none are left
+    std::vector<SuiteResult> results(entries.size());
+    std::atomic<size_t> next_entry(0);
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&]() {
+            size_t index;
+            while ((index = next_entry++) < entries.size()) run_entry(entries[index], max_depth, hash_table, results[index]);
+        });
+    }
+    for (std::thread& worker : workers) worker.join();
+    auto end = std::chrono::high_resolution_clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+    
+    // Report in file order, whichever thread finished first
+    int failed = 0;
+    long long total = 0;
+    for (size_t i = 0; i < entries.size(); i++) {
+        const SuiteResult& result = results[i];
+        std::cout << "Testing: " << entries[i].fen << "\n";
+        
+        size_t checked = 0;
+        for (const auto& expected : entries[i].expected) {
+            if (expected.first > max_depth) continue;
+            long long nodes = result.nodes[checked++];
+            std::cout << "  D" << expected.first << ": expected " << expected.second << ", got " << nodes
+                      << (nodes == expected.second ? "" : "  <-- MISMATCH") << "\n";
+        }
+        std::cout << "Time: " << result.seconds * 1000 << " ms  NPS: "
+                  << (result.seconds > 0 ? (long long)(result.total / result.seconds) : 0) << "\n";
+        std::cout << (result.passed ? "RESULT: PASS\n" : "RESULT: FAIL\n");
+        std::cout << "--------------------------------------------------\n";
+        
+        if (!result.passed) failed++;
+        total += result.total;
+    }
+    
+    std::cout << entries.size() - failed << "/" << entries.size() << " positions passed, " << total << " nodes in "
+              << seconds * 1000 << " ms (NPS: " << (seconds > 0 ? (long long)(total / seconds) : 0) << ")\n";
+    std::cout << (failed ? "SOME TESTS FAILED\n" : "ALL TESTS PASSED\n");
+    return failed ? 1 : 0;
+}
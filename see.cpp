@@ -0,0 +1,122 @@
+#include <algorithm>
+#include "see.h"
+
+const int see_value[6] = { 100, 300, 300, 500, 900, 20000 };
+
+// Least valuable piece of one side in a set of attackers; returns its type
+// (P..K) and its square bitboard in from_set, or -1 if the set is empty
+static int least_valuable_attacker(const Board& board, U64 attackers, int side, U64& from_set) {
+    int first = (side == 0) ? P : p;
+    for (int piece = first; piece < first + 6; piece++) {
+        U64 subset = attackers & board.bitboards[piece];
+        if (subset) {
+            from_set = subset & -subset;
+            return piece - first;
+        }
+    }
+    from_set = 0ULL;
+    return -1;
+}
+
+// Sliders of both sides attacking a square through an occupancy
+static U64 slider_attackers(const Board& board, int square, U64 occupancy) {
+    U64 bishop_queen = board.bitboards[B] | board.bitboards[Q] | board.bitboards[b] | board.bitboards[q];
+    U64 rook_queen = board.bitboards[R] | board.bitboards[Q] | board.bitboards[r] | board.bitboards[q];
+    return (get_bishop_attacks(square, occupancy) & bishop_queen) |
+           (get_rook_attacks(square, occupancy) & rook_queen);
+}
+
+// Value the move captures, and the occupancy once it has been played
+static int captured_value(const Board& board, Move move, U64& occupancy) {
+    int source = move_source(move);
+    int target = move_target(move);
+    occupancy = (board.occupancies[2] ^ (1ULL << source)) | (1ULL << target);
+
+    if (move_is_enpassant(move)) {
+        occupancy ^= 1ULL << (target - pawn_push_of(board.side));
+        return see_value[P];
+    }
+    int victim = piece_on(board, target);
+    return (victim == no_piece) ? 0 : see_value[victim % 6];
+}
+
+// Swap list: gain[d] is the balance for the side making capture d if the
+// exchange stops there, resolved backwards with each side free to stand pat.
+// The list is always played out in full so the value is exact; see_ge is
+// the version that stops as soon as the answer is known.
+int see(const Board& board, Move move) {
+    if (move_is_castling(move)) return 0;
+
+    int target = move_target(move);
+    int gain[32];
+    int depth = 0;
+    int side = board.side;
+    U64 occupancy;
+
+    gain[0] = captured_value(board, move, occupancy);
+    int attacker = piece_on(board, move_source(move)) % 6;
+    U64 attackers = attackers_to(target, occupancy, board.bitboards) & occupancy;
+
+    while (true) {
+        side ^= 1;
+        U64 from_set;
+        int next = least_valuable_attacker(board, attackers, side, from_set);
+        if (next < 0) break;
+
+        // The piece standing on the square is captured next
+        depth++;
+        gain[depth] = see_value[attacker] - gain[depth - 1];
+
+        // Remove the capturer; sliders behind it now see the square
+        occupancy ^= from_set;
+        attackers = (attackers | slider_attackers(board, target, occupancy)) & occupancy;
+        attacker = next;
+    }
+
+    while (depth > 0) {
+        gain[depth - 1] = -std::max(-gain[depth - 1], gain[depth]);
+        depth--;
+    }
+    return gain[0];
+}
+
+bool see_ge(const Board& board, Move move, int threshold) {
+    if (move_is_castling(move)) return threshold <= 0;
+
+    int target = move_target(move);
+    U64 occupancy;
+
+    // Even winning the captured piece for free falls short
+    int swap = captured_value(board, move, occupancy) - threshold;
+    if (swap < 0) return false;
+
+    // Even losing the moving piece for nothing stays above
+    swap = see_value[piece_on(board, move_source(move)) % 6] - swap;
+    if (swap <= 0) return true;
+
+    int side = board.side;
+    U64 attackers = attackers_to(target, occupancy, board.bitboards) & occupancy;
+    bool result = true;
+
+    while (true) {
+        side ^= 1;
+        U64 from_set;
+        int next = least_valuable_attacker(board, attackers, side, from_set);
+        if (next < 0) break;
+
+        // A king can only capture last: if the other side still has an
+        // attacker, the capture is illegal and the side to capture loses
+        if (next == K) {
+            U64 remaining = attackers & board.occupancies[side ^ 1];
+            return remaining ? result : !result;
+        }
+
+        result = !result;
+        swap = see_value[next] - swap;
+        if (swap < (int)result) break;
+
+        occupancy ^= from_set;
+        attackers = (attackers | slider_attackers(board, target, occupancy)) & occupancy;
+    }
+    return result;
+}
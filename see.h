@@ -0,0 +1,21 @@
+#ifndef SEE_H
+#define SEE_H
+
+#include "movegen.h"
+
+// Static exchange evaluation: material balance of the capture sequence a
+// move starts on its target square, each side recapturing with its least
+// valuable attacker and stopping when further captures would lose. Sliders
+// behind an attacker join in as the pieces in front of them are used up.
+// No move is played; pins and promotions during the exchange are ignored.
+
+// Piece values used by the exchange [P..K]
+extern const int see_value[6];
+
+// Exchange value of a move for the side making it. Quiet moves are played
+// out too: moving onto a square the opponent can take on returns the loss.
+int see(const Board& board, Move move);
+// Does the exchange gain at least threshold (cheaper than see, stops early)
+bool see_ge(const Board& board, Move move, int threshold);
+
+#endif
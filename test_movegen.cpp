@@ -0,0 +1,393 @@
+#include <iostream>
+#include <string>
+#include "movegen.h"
+#include "movepick.h"
+#include "see.h"
+
+// Perft with the pseudo-legal generator (legality filtered by make_move)
+long long perft_pseudo(const Board& board, int depth) {
+    if (depth == 0) return 1;
+    
+    Moves moves;
+    generate_moves(board, moves);
+    
+    long long nodes = 0;
+    for (int i = 0; i < moves.count; i++) {
+        Board next_board = board;
+        if (!make_move(next_board, moves.moves[i])) continue;
+        nodes += perft_pseudo(next_board, depth - 1);
+    }
+    return nodes;
+}
+
+// Perft with the legal generator (no legality test needed)
+long long perft_legal(const Board& board, int depth) {
+    Moves moves;
+    generate_legal_moves(board, moves);
+    if (depth == 1) return moves.count;
+    
+    long long nodes = 0;
+    for (int i = 0; i < moves.count; i++) {
+        Board next_board = board;
+        make_legal_move(next_board, moves.moves[i]);
+        nodes += perft_legal(next_board, depth - 1);
+    }
+    return nodes;
+}
+
+// Field by field comparison (no padding bytes involved)
+bool same_board(const Board& a, const Board& b) {
+    for (int i = 0; i < 12; i++) if (a.bitboards[i] != b.bitboards[i]) return false;
+    for (int i = 0; i < 3; i++) if (a.occupancies[i] != b.occupancies[i]) return false;
+    for (int i = 0; i < 64; i++) if (a.board[i] != b.board[i]) return false;
+    return a.side == b.side && a.enpassant == b.enpassant && a.castle == b.castle &&
+           a.rule50 == b.rule50 && a.fullmove == b.fullmove && a.hash == b.hash;
+}
+
+// Perft counting the last ply with count_legal_moves
+long long perft_count(const Board& board, int depth) {
+    if (depth == 1) return count_legal_moves(board);
+    
+    Moves moves;
+    generate_legal_moves(board, moves);
+    
+    long long nodes = 0;
+    for (int i = 0; i < moves.count; i++) {
+        Board next_board = board;
+        make_legal_move(next_board, moves.moves[i]);
+        nodes += perft_count(next_board, depth - 1);
+    }
+    return nodes;
+}
+
+// Perft with make/unmake. Returns -1 if the incremental hash drifts from a
+// full recomputation or unmake_move does not restore the position exactly.
+long long perft_unmake(Board& board, int depth) {
+    Moves moves;
+    generate_legal_moves(board, moves);
+    if (depth == 1) return moves.count;
+    
+    long long nodes = 0;
+    for (int i = 0; i < moves.count; i++) {
+        Board before = board;
+        Undo undo;
+        make_legal_move(board, moves.moves[i], undo);
+        if (board.hash != compute_hash(board)) return -1;
+        
+        long long child = perft_unmake(board, depth - 1);
+        if (child < 0) return -1;
+        nodes += child;
+        
+        unmake_move(board, moves.moves[i], undo);
+        if (!same_board(board, before)) return -1;
+    }
+    return nodes;
+}
+
+// Perft walking the staged move picker. The hash move is one of the legal
+// moves, the killers are moves of the same side two plies up and may not be
+// valid here.
+long long perft_picker(const Board& board, int depth, Move killer1, Move killer2, Move next_killer1, Move next_killer2) {
+    Moves moves;
+    generate_legal_moves(board, moves);
+    
+    MovePicker picker;
+    init_move_picker(picker, board, moves.count ? moves.moves[moves.count / 2] : 0, killer1, killer2);
+    
+    long long nodes = 0;
+    int count = 0;
+    Move move;
+    while ((move = next_move(picker))) {
+        // Every move handed out must be one of the legal moves
+        int found = 0;
+        for (int i = 0; i < moves.count; i++) found |= (moves.moves[i] == move);
+        if (!found) return -1;
+        
+        count++;
+        if (depth > 1) {
+            Board next_board = board;
+            make_legal_move(next_board, move);
+            long long child = perft_picker(next_board, depth - 1, next_killer1, next_killer2, moves.moves[0], moves.moves[moves.count - 1]);
+            if (child < 0) return -1;
+            nodes += child;
+        }
+    }
+    if (count != moves.count) return -1;
+    return (depth > 1) ? nodes : count;
+}
+
+// Moves out of all 65536 encodings where is_pseudo_legal / is_legal disagree
+// with the generated lists
+int validity_mismatches(const char* fen) {
+    Board board;
+    parse_fen((char*)fen, board);
+    Moves pseudo, legal;
+    generate_moves(board, pseudo);
+    generate_legal_moves(board, legal);
+    
+    int mismatches = 0;
+    for (int move = 0; move < 65536; move++) {
+        bool in_pseudo = false, in_legal = false;
+        for (int i = 0; i < pseudo.count; i++) in_pseudo |= (pseudo.moves[i] == move);
+        for (int i = 0; i < legal.count; i++) in_legal |= (legal.moves[i] == move);
+        
+        bool pseudo_ok = is_pseudo_legal(board, (Move)move);
+        if (pseudo_ok != in_pseudo || (pseudo_ok && is_legal(board, (Move)move) != in_legal)) mismatches++;
+    }
+    return mismatches;
+}
+
+// Legal moves in a perft tree where gives_check disagrees with making the
+// move and testing the enemy king
+long long check_mismatches(const Board& board, int depth) {
+    Moves moves;
+    generate_legal_moves(board, moves);
+    CheckInfo info;
+    init_check_info(board, info);
+    
+    long long mismatches = 0;
+    for (int i = 0; i < moves.count; i++) {
+        Board next_board = board;
+        make_legal_move(next_board, moves.moves[i]);
+        U64 king = next_board.bitboards[(next_board.side == 0) ? K : k];
+        bool in_check = king && is_square_attacked(__builtin_ctzll(king), board.side, next_board.bitboards, next_board.occupancies);
+        if (gives_check(board, moves.moves[i], info) != in_check) mismatches++;
+        if (depth > 1) mismatches += check_mismatches(next_board, depth - 1);
+    }
+    return mismatches;
+}
+
+// Slider lookups that disagree with the ray-walking reference, over random
+// occupancies on every square
+int slider_mismatches() {
+    U64 seed = 0x9e3779b97f4a7c15ULL;
+    int mismatches = 0;
+    for (int square = 0; square < 64; square++) {
+        for (int i = 0; i < 1000; i++) {
+            // Sparse and dense boards: AND / OR of two xorshift values
+            U64 a = (seed ^= seed << 13, seed ^= seed >> 7, seed ^= seed << 17);
+            U64 b = (seed ^= seed << 13, seed ^= seed >> 7, seed ^= seed << 17);
+            U64 occupancy = (i & 1) ? (a & b) : (a | b);
+            
+            U64 bishop = bishop_attacks_on_the_fly(square, occupancy);
+            U64 rook = rook_attacks_on_the_fly(square, occupancy);
+            if (get_bishop_attacks(square, occupancy) != bishop) mismatches++;
+            if (get_rook_attacks(square, occupancy) != rook) mismatches++;
+            if (get_queen_attacks(square, occupancy) != (bishop | rook)) mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+// Captures of a position where see_ge disagrees with see at some threshold
+int see_mismatches(const char* fen) {
+    Board board;
+    parse_fen((char*)fen, board);
+    Moves moves;
+    generate<GEN_CAPTURES>(board, moves);
+    
+    int mismatches = 0;
+    for (int i = 0; i < moves.count; i++) {
+        int value = see(board, moves.moves[i]);
+        for (int threshold = -1000; threshold <= 1000; threshold += 50) {
+            if (see_ge(board, moves.moves[i], threshold) != (value >= threshold)) mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+// Exchange value of a move given as source/target squares
+int see_of(const char* fen, int source, int target, int flag) {
+    Board board;
+    parse_fen((char*)fen, board);
+    return see(board, new_move(source, target, flag));
+}
+
+// Generated during static initialization, before attacks.cpp's own
+// initializer when this file is linked first: parse_fen builds the slider
+// tables on demand
+static const int static_init_moves = [] {
+    Board board;
+    parse_fen((char*)"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", board);
+    return count_legal_moves(board);
+}();
+
+int failures = 0;
+
+// Compare the generators against a known node count
+void test_perft(std::string label, const char* fen, int depth, long long expected) {
+    Board board;
+    parse_fen((char*)fen, board);
+    
+    long long pseudo = perft_pseudo(board, depth);
+    long long legal = perft_legal(board, depth);
+    long long counted = perft_count(board, depth);
+    
+    std::cout << "Testing: " << label << " (depth " << depth << ")\n";
+    std::cout << "Expected: " << expected << "  Pseudo-legal: " << pseudo << "  Legal: " << legal << "  Counted: " << counted << "\n";
+    
+    if (pseudo == expected && legal == expected && counted == expected) {
+        std::cout << "RESULT: PASS\n";
+    } else {
+        std::cout << "RESULT: FAIL\n";
+        failures++;
+    }
+    std::cout << "--------------------------------------------------\n";
+}
+
+// Count the moves of one generation mode
+template <int Type>
+int count_mode(const char* fen) {
+    Board board;
+    parse_fen((char*)fen, board);
+    Moves moves;
+    generate<Type>(board, moves);
+    return moves.count;
+}
+
+// Compare a generation mode against a known move count
+void test_mode(std::string label, int count, int expected) {
+    std::cout << "Testing: " << label << "\n";
+    std::cout << "Expected: " << expected << "  Generated: " << count << "\n";
+    if (count == expected) {
+        std::cout << "RESULT: PASS\n";
+    } else {
+        std::cout << "RESULT: FAIL\n";
+        failures++;
+    }
+    std::cout << "--------------------------------------------------\n";
+}
+
+int main() {
+    // Slider lookups of the active backend against the reference loops
+    test_mode(std::string("Slider Attacks (") + slider_backend_name() + ")", slider_mismatches(), 0);
+    test_mode("Moves From A Static Initializer (KiwiPete)", static_init_moves, 48);
+    
+    // Standard perft positions (chessprogramming.org "Perft Results")
+    test_perft("Start Position", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 4, 197281);
+    test_perft("KiwiPete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 3, 97862);
+    test_perft("Position 3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 5, 674624);
+    test_perft("Position 4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 3, 9467);
+    test_perft("Position 5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 3, 62379);
+    test_perft("Position 6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 3, 89890);
+    
+    // En passant edge cases
+    // Horizontal discovered check: exd3 would expose the king on the 4th rank
+    test_perft("EP Rank Pin", "8/8/8/8/k2Pp2Q/8/8/3K4 b - d3 0 1", 1, 6);
+    // Pawn pinned on a diagonal through the ep square: exd3 stays on the pin, e3 does not
+    test_perft("EP Diagonal Pin", "8/7k/8/8/3Pp3/8/8/1B2K3 b - d3 0 1", 1, 6);
+    // Double push gives check, capturing it en passant is an evasion
+    test_perft("EP Evasion", "8/8/8/4k3/3Pp3/8/8/4K3 b - d3 0 1", 1, 8);
+    // Pinned pawns on edge squares: the destination check must not shift off the board
+    test_perft("Edge Pin (a7 under a8 rook)", "r7/P7/8/8/8/8/8/K6k w - - 0 1", 2, 33);
+    test_perft("Edge Pin (h2 over h1 rook)", "7k/8/8/8/8/8/7p/K6R b - - 0 1", 2, 30);
+    test_perft("EP Captures Checker", "8/8/8/2k5/3Pp3/8/8/4K3 b - d3 0 1", 1, 9);
+    
+    // Generation modes
+    const char* kiwipete = "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1";
+    test_mode("Captures (KiwiPete)", count_mode<GEN_CAPTURES>(kiwipete), 8);
+    test_mode("Captures + Quiets (KiwiPete)", count_mode<GEN_CAPTURES>(kiwipete) + count_mode<GEN_QUIETS>(kiwipete), 48);
+    test_mode("Evasions, not in check (KiwiPete)", count_mode<GEN_EVASIONS>(kiwipete), 0);
+    test_mode("Evasions (EP Evasion)", count_mode<GEN_EVASIONS>("8/8/8/4k3/3Pp3/8/8/4K3 b - d3 0 1"), 8);
+    // Rf1+, Rh8+ and O-O+ (the rook lands on f1 with check)
+    test_mode("Quiet Checks (Castling)", count_mode<GEN_QUIET_CHECKS>("5k2/8/8/8/8/8/8/4K2R w K - 0 1"), 3);
+    
+    // Without a king every move is legal, the mode still applies
+    const char* kingless = "n7/8/8/8/8/8/4P3/R7 w - - 0 1";
+    test_mode("Kingless All", count_mode<GEN_ALL>(kingless), 16);
+    test_mode("Kingless Captures", count_mode<GEN_CAPTURES>(kingless), 1);
+    test_mode("Kingless Quiets", count_mode<GEN_QUIETS>(kingless), 15);
+    test_mode("Kingless Evasions", count_mode<GEN_EVASIONS>(kingless), 0);
+    test_mode("Kingless Quiet Checks", count_mode<GEN_QUIET_CHECKS>(kingless), 0);
+    // Ra8+ (the e-pawn blocks the file)
+    test_mode("Kingless Quiet Checks (Enemy King)", count_mode<GEN_QUIET_CHECKS>("4k3/8/8/8/8/8/4P3/R7 w - - 0 1"), 1);
+    
+    // Visitor API: counting without a list, early stop for mate/stalemate
+    Board position;
+    parse_fen((char*)kiwipete, position);
+    int visited = 0;
+    generate<GEN_ALL>(position, [&visited](Move) { visited++; return true; });
+    test_mode("Visitor Count (KiwiPete)", visited, 48);
+    test_mode("Has Legal Move (KiwiPete)", has_legal_move(position), 1);
+    parse_fen((char*)"rnb1kbnr/pppp1ppp/8/4p3/6Pq/5P2/PPPPP2P/RNBQKBNR w KQkq - 1 3", position);
+    test_mode("Has Legal Move (Checkmate)", has_legal_move(position), 0);
+    parse_fen((char*)"7k/5Q2/6K1/8/8/8/8/8 b - - 0 1", position);
+    test_mode("Has Legal Move (Stalemate)", has_legal_move(position), 0);
+    
+    // UCI strings round-trip through parse_uci_move
+    parse_fen((char*)"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", position);
+    Moves legal;
+    generate_legal_moves(position, legal);
+    int round_trips = 0;
+    for (int i = 0; i < legal.count; i++) round_trips += (parse_uci_move(position, move_to_uci(legal.moves[i])) == legal.moves[i]);
+    test_mode("UCI Round Trip (Position 4)", round_trips, 6);
+    
+    // FEN checks: only the first three are valid positions
+    const char* fens[] = {
+        "4k3/8/8/8/8/8/8/4K3 w - - 0 1", "r3k2r/8/8/8/4P3/8/8/R3K2R b KQkq e3",
+        "4k3/8/8/3pP3/8/8/8/4K3 w - d6 0 2",
+        // Incomplete or malformed
+        "4k3/8/8/8/8/8/8/4K3 w", "4k3/8/8/8/8/8/8/4K3 w KQkq", "4k3/8/8/8/8/8/8/4K3 w - e9 0 1",
+        "4k3/8/8/8/8/8/4K3 w - - 0 1", "4k3/9/8/8/8/8/8/4K3 w - - 0 1", "4k3/8/8/8/8/8/8/4K3 x - - 0 1",
+        // Castling rights without the king or rook at home
+        "4k3/8/8/8/8/8/8/K7 w K - 0 1", "4k3/8/8/8/8/8/8/4K3 w K - 0 1", "r3k3/8/8/8/8/8/8/4K3 w k - 0 1",
+        // En passant on the wrong rank for the side to move, or with no pawn to capture
+        "4k3/8/8/8/8/8/3PP3/4K3 w - e3 0 1", "4k3/8/8/8/8/8/8/4K3 w - e6 0 1",
+        // King count, pawns on the back ranks
+        "8/8/8/8/8/8/8/4K3 w - - 0 1", "4k3/8/8/8/8/8/8/3KK3 w - - 0 1", "P3k3/8/8/8/8/8/8/4K3 w - - 0 1"
+    };
+    int valid_fens = 0;
+    for (const char* fen : fens) valid_fens += is_valid_fen(fen);
+    test_mode("Valid FENs", valid_fens, 3);
+    
+    // Single move validity matches full generation
+    test_mode("Move Validity (KiwiPete)", validity_mismatches(kiwipete), 0);
+    test_mode("Move Validity (Position 4)", validity_mismatches("r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1"), 0);
+    test_mode("Move Validity (EP Rank Pin)", validity_mismatches("8/8/8/8/k2Pp2Q/8/8/3K4 b - d3 0 1"), 0);
+    
+    // Make/unmake restores every position and keeps the hash in step
+    Board board;
+    parse_fen((char*)"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", board);
+    test_mode("Make/Unmake (Position 4, depth 3)", (int)perft_unmake(board, 3), 9467);
+    
+    // Gives check agrees with make + king attack test
+    const char* check_positions[] = {
+        kiwipete,
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+        "8/8/8/8/k2Pp2Q/8/8/3K4 b - d3 0 1"
+    };
+    long long check_errors = 0;
+    for (const char* fen : check_positions) {
+        parse_fen((char*)fen, board);
+        check_errors += check_mismatches(board, 3);
+    }
+    test_mode("Gives Check (perft positions, depth 3)", (int)check_errors, 0);
+    
+    // Static exchange evaluation (chessprogramming.org "SEE" examples)
+    // Rxe5: the pawn is undefended
+    test_mode("SEE Free Pawn", see_of("1k1r4/1pp4p/p7/4p3/8/P5P1/1PP4P/2K1R3 w - - 0 1", e1, e5, QUIET), 100);
+    // Nxe5: knight, rook and queen battery against knight, bishop and queen x-ray
+    test_mode("SEE Defended Pawn", see_of("1k1r3q/1ppn3p/p4b2/4p3/8/P2N2P1/1PP1R1BP/2K1Q3 w - - 0 1", d3, e5, QUIET), -200);
+    // Rxd5: the queen cannot recapture, the rook behind would take it
+    test_mode("SEE X-Ray Battery", see_of("4k3/3q4/8/3p4/8/8/3R4/3RK3 w - - 0 1", d2, d5, QUIET), 100);
+    // Qxd5: the pawn is defended by a pawn
+    test_mode("SEE Bad Capture", see_of("4k3/8/2p5/3p4/8/8/8/3QK3 w - - 0 1", d1, d5, QUIET), -800);
+    // Qe4 (quiet) walks into the d5 pawn
+    test_mode("SEE Quiet Move", see_of("4k3/8/8/3p4/8/3Q4/8/4K3 w - - 0 1", d3, e4, QUIET), -900);
+    test_mode("SEE Consistency (KiwiPete)", see_mismatches(kiwipete), 0);
+    test_mode("SEE Consistency (Position 4)", see_mismatches("r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1"), 0);
+    
+    // Staged picker hands out exactly the legal moves
+    parse_fen((char*)kiwipete, board);
+    long long picked = perft_picker(board, 3, 0, 0, 0, 0);
+    std::cout << "Testing: Move Picker (KiwiPete, depth 3)\n";
+    std::cout << "Expected: 97862  Picker: " << picked << "\n";
+    std::cout << (picked == 97862 ? "RESULT: PASS\n" : "RESULT: FAIL\n");
+    std::cout << "--------------------------------------------------\n";
+    if (picked != 97862) failures++;
+    
+    std::cout << (failures ? "SOME TESTS FAILED\n" : "ALL TESTS PASSED\n");
+    return failures ? 1 : 0;
+}